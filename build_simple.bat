@@ -45,7 +45,7 @@ if /i "%BUILD_TYPE%"=="debug" (
     echo [INFO] Building optimized release version...
 )
 
-set LDFLAGS=-lm
+set LDFLAGS=-lm -lpthread
 
 echo [STEP] Compiling source files...
 
@@ -82,6 +82,142 @@ if %errorlevel% neq 0 (
     exit /b 1
 )
 
+echo   Compiling benchmark.c...
+gcc !CFLAGS! -c %SRC_DIR%\benchmark.c -o %OBJ_DIR%\benchmark.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile benchmark.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling report.c...
+gcc !CFLAGS! -c %SRC_DIR%\report.c -o %OBJ_DIR%\report.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile report.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling compare.c...
+gcc !CFLAGS! -c %SRC_DIR%\compare.c -o %OBJ_DIR%\compare.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile compare.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling perf_counters.c...
+gcc !CFLAGS! -c %SRC_DIR%\perf_counters.c -o %OBJ_DIR%\perf_counters.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile perf_counters.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling roofline.c...
+gcc !CFLAGS! -c %SRC_DIR%\roofline.c -o %OBJ_DIR%\roofline.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile roofline.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling phase_timing.c...
+gcc !CFLAGS! -c %SRC_DIR%\phase_timing.c -o %OBJ_DIR%\phase_timing.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile phase_timing.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling matrix_parallel.c...
+gcc !CFLAGS! -c %SRC_DIR%\matrix_parallel.c -o %OBJ_DIR%\matrix_parallel.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile matrix_parallel.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling trace.c...
+gcc !CFLAGS! -c %SRC_DIR%\trace.c -o %OBJ_DIR%\trace.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile trace.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling energy.c...
+gcc !CFLAGS! -c %SRC_DIR%\energy.c -o %OBJ_DIR%\energy.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile energy.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling freq_monitor.c...
+gcc !CFLAGS! -c %SRC_DIR%\freq_monitor.c -o %OBJ_DIR%\freq_monitor.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile freq_monitor.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling cache_control.c...
+gcc !CFLAGS! -c %SRC_DIR%\cache_control.c -o %OBJ_DIR%\cache_control.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile cache_control.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling sweep.c...
+gcc !CFLAGS! -c %SRC_DIR%\sweep.c -o %OBJ_DIR%\sweep.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile sweep.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling kernel_registry.c...
+gcc !CFLAGS! -c %SRC_DIR%\kernel_registry.c -o %OBJ_DIR%\kernel_registry.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile kernel_registry.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling scaling.c...
+gcc !CFLAGS! -c %SRC_DIR%\scaling.c -o %OBJ_DIR%\scaling.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile scaling.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling uarch_probe.c...
+gcc !CFLAGS! -c %SRC_DIR%\uarch_probe.c -o %OBJ_DIR%\uarch_probe.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile uarch_probe.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling perf_model.c...
+gcc !CFLAGS! -c %SRC_DIR%\perf_model.c -o %OBJ_DIR%\perf_model.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile perf_model.c
+    pause
+    exit /b 1
+)
+
+echo   Compiling matrix_rvv.c...
+gcc !CFLAGS! -c %SRC_DIR%\matrix_rvv.c -o %OBJ_DIR%\matrix_rvv.o
+if %errorlevel% neq 0 (
+    echo [ERROR] Failed to compile matrix_rvv.c
+    pause
+    exit /b 1
+)
+
 echo   Compiling main.c...
 gcc !CFLAGS! -c %SRC_DIR%\main.c -o %OBJ_DIR%\main.o
 if %errorlevel% neq 0 (
@@ -0,0 +1,80 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Per-iteration callbacks run outside the timed region of each sample
+typedef struct {
+    void (*before_sample)(void *user);
+    void (*after_sample)(void *user, size_t iteration, double seconds);
+    void *user;
+} BenchHook;
+
+#define BENCH_MAX_HOOKS 8
+
+// Benchmark harness configuration
+typedef struct {
+    int warmup_iterations;      // Untimed runs before sampling starts
+    int min_iterations;         // Timed runs required before the CI check applies
+    int max_iterations;         // Hard cap on timed runs
+    double target_rel_ci;       // Stop once the 95% CI half-width / mean drops below this
+    double time_budget_seconds; // Stop sampling once this much time has been spent
+    int single_shot;            // One untimed-warmup-free run, legacy behaviour
+    void (*prepare)(void *user); // Run untimed before every call but the first
+    void *prepare_user;
+    const BenchHook *hooks[BENCH_MAX_HOOKS];
+    int num_hooks;
+} BenchConfig;
+
+// Summary statistics over the timed samples (all times in seconds)
+typedef struct {
+    size_t count;
+    double min;
+    double max;
+    double mean;
+    double median;
+    double p90;
+    double stddev;
+    double cv;          // stddev / mean
+    double rel_ci95;    // 95% confidence half-width relative to the mean
+} BenchStats;
+
+// Result of benchmarking a single kernel
+typedef struct {
+    double *samples;    // Per-iteration times in seconds, in execution order
+    size_t count;
+    size_t capacity;
+    int warmups_run;
+    double first_call_seconds; // Very first call, with first-touch costs
+    double total_seconds; // Wall time spent in warmups and samples
+    BenchStats stats;
+} BenchResult;
+
+typedef void (*bench_fn)(void *ctx);
+
+// Configuration
+void bench_config_default(BenchConfig *cfg);
+int bench_add_hook(BenchConfig *cfg, const BenchHook *hook);
+
+// Run fn repeatedly according to cfg; returns 0 on success, -1 on allocation failure
+int bench_run(const BenchConfig *cfg, bench_fn fn, void *ctx, BenchResult *result);
+// Interleave samples of two kernels; sample i of each forms a pair
+int bench_run_paired(const BenchConfig *cfg, bench_fn fn_a, void *ctx_a,
+                     bench_fn fn_b, void *ctx_b, BenchResult *result_a, BenchResult *result_b);
+void bench_result_free(BenchResult *result);
+
+// Statistics helpers
+void bench_stats_compute(const double *samples, size_t count, BenchStats *stats);
+double bench_percentile(const double *sorted, size_t count, double p);
+double bench_t_critical95(size_t dof);
+
+// Reporting
+void print_benchmark_header(FILE *out);
+void print_benchmark_result(FILE *out, const char *method, size_t matrix_size,
+                            const BenchResult *result);
+void print_first_call_header(FILE *out);
+void print_first_call_result(FILE *out, const char *method, size_t matrix_size,
+                             const BenchResult *result);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,36 @@
+#ifndef CACHE_CONTROL_H
+#define CACHE_CONTROL_H
+
+#include <stddef.h>
+
+// What the caches hold when each timed call starts
+typedef enum {
+    CACHE_WARM,     // Operands pre-touched, as in a tight loop
+    CACHE_COLD      // Caches flushed, as after unrelated work
+} CacheMode;
+
+// Flush buffer streamed between calls in cold mode
+typedef struct {
+    unsigned char *buffer;
+    size_t bytes;
+} CacheFlusher;
+
+// Returns 0 and sets *mode for "cold" or "warm"
+int cache_parse_mode(const char *text, CacheMode *mode);
+const char* cache_mode_name(CacheMode mode);
+
+// bytes == 0 picks twice the last-level cache size
+int cache_flusher_init(CacheFlusher *cf, size_t bytes);
+void cache_flusher_free(CacheFlusher *cf);
+void cache_flush(CacheFlusher *cf);
+
+// Read (or read and write back) one word per cache line
+void cache_touch(void *data, size_t bytes, int write);
+
+// Zero bytes at data without first reading the lines where the machine
+// allows it: cbo.zero when Linux reports Zicboz, non-temporal stores on x86
+// for buffers larger than the last-level cache, memset otherwise
+void cache_zero(void *data, size_t bytes);
+const char* cache_zero_method(void);
+
+#endif // CACHE_CONTROL_H
@@ -0,0 +1,82 @@
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// One configuration from a baseline results file with its timing samples
+typedef struct {
+    char kernel[64];
+    size_t size;
+    size_t tile;
+    int threads;
+    double *samples;    // Seconds
+    size_t count;
+    size_t capacity;
+} BaselineEntry;
+
+typedef struct {
+    BaselineEntry *entries;
+    size_t count;
+    size_t capacity;
+} Baseline;
+
+// Regression gate configuration
+typedef struct {
+    double alpha;       // Significance level of the one-sided tests
+    double threshold;   // Minimum relative median change worth flagging
+} CompareConfig;
+
+typedef enum {
+    COMPARE_UNCHANGED,
+    COMPARE_IMPROVED,
+    COMPARE_REGRESSED,
+    COMPARE_INCONCLUSIVE
+} CompareVerdict;
+
+typedef struct {
+    CompareVerdict verdict;
+    double ratio;           // Current median / baseline median
+    double p_slower;        // P-value for "current is slower"
+    double p_faster;        // P-value for "current is faster"
+} CompareResult;
+
+// Paired A/B comparison of two kernels timed in alternation
+typedef struct {
+    double speedup;         // Geometric mean of time_a / time_b over the pairs
+    double ci_low;          // Bootstrap 95% percentile interval of speedup
+    double ci_high;
+    size_t pairs;
+} PairedResult;
+
+// Minimum samples per side for the rank test to be meaningful
+#define COMPARE_MIN_SAMPLES 3
+
+// Baseline files are the CSV records written by --format=csv
+int baseline_load(const char *path, Baseline *baseline);
+void baseline_free(Baseline *baseline);
+
+// Mann-Whitney U test (normal approximation with tie correction).
+// Returns the one-sided p-value that samples in a tend to exceed those in b.
+double mann_whitney_p_greater(const double *a, size_t na, const double *b, size_t nb);
+
+void compare_config_default(CompareConfig *cfg);
+void compare_samples(const CompareConfig *cfg,
+                     const double *current, size_t current_count,
+                     const double *baseline, size_t baseline_count,
+                     CompareResult *result);
+const char* compare_verdict_name(CompareVerdict verdict);
+
+// Resample whole pairs so that drift shared by a pair cancels out.
+// Returns -1 on allocation failure, fewer than two pairs or a sample that
+// is not positive.
+int compare_paired_bootstrap(const double *a, const double *b, size_t count,
+                             size_t resamples, PairedResult *result);
+
+void print_compare_header(FILE *out);
+void print_compare_result(FILE *out, const BaselineEntry *entry,
+                          double current_median, const CompareResult *result);
+void print_paired_result(FILE *out, const char *name_a, const char *name_b,
+                         const PairedResult *result);
+
+#endif // COMPARE_H
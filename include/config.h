@@ -16,7 +16,34 @@
 
 // Timing configuration
 #define WARMUP_ITERATIONS 3
-#define BENCHMARK_ITERATIONS 5
+#define BENCHMARK_ITERATIONS 5          // Minimum timed iterations per kernel
+#define BENCHMARK_MAX_ITERATIONS 100     // Upper bound on timed iterations
+#define BENCHMARK_TARGET_REL_CI 0.02     // Stop once the 95% CI is within +/-2% of the mean
+#define BENCHMARK_TIME_BUDGET 2.0        // Seconds of sampling allowed per kernel
+
+// Threading configuration
+#define MAX_THREADS 64                   // Upper bound for --threads and trace buffers
+
+// Frequency stability configuration
+#define FREQ_SAMPLE_INTERVAL_MS 10.0     // cpufreq/thermal polling period during a sample
+#define FREQ_STABILITY_THRESHOLD 0.05    // Flag samples whose clock moved more than 5%
+
+// Roofline configuration
+#define ROOFLINE_TEST_SECONDS 0.3        // Time spent on each ceiling microbenchmark
+
+// Thread scaling configuration
+#define SCALING_STREAM_SECONDS 0.2       // Threaded triad time per thread count
+#define SCALING_SATURATION 0.9           // Bandwidth within 10% of the best counts as saturated
+
+// Machine probe configuration
+#define UARCH_PROFILE_PATH "machine.profile" // Written by --probe, read at start-up
+#define UARCH_SATURATION 0.9             // FMA rate within 10% of the best counts as saturated
+#define UARCH_LEVEL_JUMP 1.4             // Load latency rise that ends a cache level
+
+// Regression gate configuration
+#define COMPARE_DEFAULT_ALPHA 0.05       // Significance level of the rank test
+#define COMPARE_DEFAULT_THRESHOLD 0.05   // Ignore median changes below 5%
+#define COMPARE_BOOTSTRAP_RESAMPLES 10000 // Resamples behind the --ab confidence interval
 
 // Vector configuration
 #ifdef USE_VECTOR
@@ -26,6 +53,22 @@
     #define VECTOR_ENABLED 0
 #endif
 
+// Tiled kernel tiles run on the register-blocked, software-pipelined
+// micro-kernel of TiledReg; on by default for scalar RISC-V, whose in-order
+// cores stall on load-use latency in the dot loop (make TILED_REGISTER=0/1)
+#ifndef TILED_REGISTER_BLOCK
+    #if defined(__riscv) && !defined(__riscv_vector)
+        #define TILED_REGISTER_BLOCK 1
+    #else
+        #define TILED_REGISTER_BLOCK 0
+    #endif
+#endif
+
+// VLEN in bits of the emulated RVV registers off RISC-V (make RVV_VLEN=512)
+#ifndef RVV_EMUL_VLEN
+    #define RVV_EMUL_VLEN 256
+#endif
+
 // Debug configuration
 #ifdef DEBUG
     #define DEBUG_ENABLED 1
@@ -38,7 +81,32 @@
 // Optimization hints for compiler
 #define LIKELY(x)   __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
-#define PREFETCH(addr) __builtin_prefetch(addr, 0, 3)
+
+// Software prefetch for reading and for writing. On RISC-V these are the
+// Zicbop prefetch.r and prefetch.w encodings, hints (ori x0) that cores
+// without Zicbop execute as no-ops, so they need no detection.
+#if defined(__riscv)
+#define PREFETCH(addr)   __asm__ volatile(".insn i 0x13, 6, x0, %0, 1" : : "r"(addr))
+#define PREFETCH_W(addr) __asm__ volatile(".insn i 0x13, 6, x0, %0, 3" : : "r"(addr))
+#else
+#define PREFETCH(addr)   __builtin_prefetch(addr, 0, 3)
+#define PREFETCH_W(addr) __builtin_prefetch(addr, 1, 3)
+#endif
+
+// Iterations ahead that the tiled and vector inner loops prefetch their A
+// and B panels, the default of --prefetch (make PREFETCH_DISTANCE=N, 0 off).
+// In-order RISC-V cores have little hardware prefetch to carry a stream
+// across tile boundaries. x86 hardware prefetchers already do, and the extra
+// instructions cost more than they save in most kernels there.
+#ifndef PREFETCH_DISTANCE
+    #if defined(__riscv)
+        #define PREFETCH_DISTANCE 4
+    #else
+        #define PREFETCH_DISTANCE 0
+    #endif
+#endif
+#define PREFETCH_DISTANCE_MAX 256
+#define PREFETCH_LINE_DOUBLES (CACHE_LINE_SIZE / sizeof(double))
 
 // Cache size hints (typical RISC-V values)
 #define L1_CACHE_SIZE (32 * 1024)    // 32KB
@@ -0,0 +1,61 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "benchmark.h"
+
+#define ENERGY_MAX_SOURCES 16
+
+// Cumulative energy counters (RAPL energy_uj, hwmon energy*_input) are
+// differenced; instantaneous power sensors (hwmon power*_input) are
+// averaged over the sample and multiplied by its duration.
+typedef enum {
+    ENERGY_COUNTER,
+    ENERGY_POWER
+} EnergySourceKind;
+
+typedef struct {
+    char path[256];
+    char label[64];
+    EnergySourceKind kind;
+    double max_range_uj;    // Counter wraparound, 0 when unknown
+} EnergySource;
+
+typedef struct {
+    EnergySource sources[ENERGY_MAX_SOURCES];
+    int count;
+    char error[128];        // Why no source could be used, if none could
+} EnergyMeter;
+
+// Raw readings of every source: microjoules or microwatts
+typedef struct {
+    double values[ENERGY_MAX_SOURCES];
+} EnergyReading;
+
+// Collects the energy of every timed iteration through a BenchHook
+typedef struct {
+    const EnergyMeter *meter;
+    EnergyReading before;
+    double *joules;
+    size_t count;
+    size_t capacity;
+    BenchHook hook;
+} EnergyRecorder;
+
+// Returns 0 when at least one readable source was found
+int energy_open(EnergyMeter *em);
+void energy_read(const EnergyMeter *em, EnergyReading *reading);
+double energy_joules(const EnergyMeter *em, const EnergyReading *before,
+                     const EnergyReading *after, double seconds);
+
+void energy_recorder_init(EnergyRecorder *rec, const EnergyMeter *em);
+void energy_recorder_reset(EnergyRecorder *rec);
+void energy_recorder_free(EnergyRecorder *rec);
+
+void print_energy_sources(FILE *out, const EnergyMeter *em);
+void print_energy_header(FILE *out);
+void print_energy_result(FILE *out, const char *method, size_t matrix_size,
+                         const double *joules, const BenchResult *result);
+
+#endif // ENERGY_H
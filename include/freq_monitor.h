@@ -0,0 +1,60 @@
+#ifndef FREQ_MONITOR_H
+#define FREQ_MONITOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "config.h"
+#include "benchmark.h"
+
+#define FREQ_MAX_ZONES 16
+
+// Clock and temperature seen during one timed iteration
+typedef struct {
+    double mean_khz;        // Mean over polls of the fastest CPU, 0 if unknown
+    double min_khz;
+    double max_khz;
+    double max_temp_c;      // Hottest thermal zone, 0 if unknown
+    int polls;
+    int stable;             // Set by freq_mark_stable()
+} FreqSample;
+
+// Polls cpufreq and thermal zones from a helper thread while a sample runs
+typedef struct {
+    int freq_fds[MAX_THREADS];
+    int num_cpus;
+    int zone_fds[FREQ_MAX_ZONES];
+    int num_zones;
+    double interval_ms;
+    void *sampler;          // Platform thread state, NULL when not started
+    char error[128];
+} FreqMonitor;
+
+// Collects a FreqSample for every timed iteration through a BenchHook
+typedef struct {
+    FreqMonitor *monitor;
+    FreqSample *samples;
+    size_t count;
+    size_t capacity;
+    BenchHook hook;
+} FreqRecorder;
+
+// Returns 0 when scaling_cur_freq or a thermal zone is readable
+int freq_monitor_open(FreqMonitor *fm, double interval_ms);
+void freq_monitor_close(FreqMonitor *fm);
+void freq_monitor_begin(FreqMonitor *fm);
+void freq_monitor_end(FreqMonitor *fm, FreqSample *sample);
+
+void freq_recorder_init(FreqRecorder *rec, FreqMonitor *fm);
+void freq_recorder_reset(FreqRecorder *rec);
+void freq_recorder_free(FreqRecorder *rec);
+
+// Flag samples whose clock moved more than threshold (relative) away from
+// the median clock of the run, or varied by more than that within the
+// sample. Returns the number of unstable samples.
+size_t freq_mark_stable(FreqSample *samples, size_t count, double threshold);
+
+void print_stability_header(FILE *out);
+void print_stability_result(FILE *out, const char *method, size_t matrix_size,
+                            const FreqSample *samples, const BenchResult *result);
+
+#endif // FREQ_MONITOR_H
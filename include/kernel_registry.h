@@ -0,0 +1,74 @@
+#ifndef KERNEL_REGISTRY_H
+#define KERNEL_REGISTRY_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "matrix.h"
+#include "benchmark.h"
+#include "roofline.h"
+#include "perf_model.h"
+
+#define KERNEL_REGISTRY_MAX 32
+
+// Arguments shared by every registered kernel; run() receives a pointer to
+// one of these as its bench_fn context
+typedef struct {
+    const Matrix *A;
+    const Matrix *B;
+    Matrix *C;
+    size_t tile_size;
+    int threads;
+    const Matrix *Bt;   // B stored transposed (p x m), for KERNEL_TRANSPOSED_B
+} KernelArgs;
+
+// Kernel capabilities
+#define KERNEL_USES_TILE        (1u << 0)   // Honours tile_size
+#define KERNEL_USES_THREADS     (1u << 1)   // Honours threads
+#define KERNEL_TRANSPOSED_B     (1u << 2)   // Reads B from Bt instead of B
+#define KERNEL_USES_PREFETCH    (1u << 3)   // Honours matrix_prefetch_distance
+
+#define KERNEL_DTYPE_F64        (1u << 0)
+
+#define KERNEL_SHAPE_SQUARE     (1u << 0)
+#define KERNEL_SHAPE_RECT       (1u << 1)   // Any (n x m) * (m x p)
+
+typedef struct {
+    const char *name;           // Reported name, matched case-insensitively
+    const char *description;
+    bench_fn run;
+    const char *isa;            // Instruction set the kernel was written for
+    unsigned flags;
+    unsigned dtypes;
+    unsigned shapes;
+    roof_traffic_fn traffic;    // DRAM traffic model for --roofline
+    model_blocking_fn blocking; // Loop blocking for --model, NULL if not modelled
+    int order;                  // Position in reports, lowest first
+} KernelInfo;
+
+// Kernels register themselves from a constructor in their own source file,
+// so a new kernel needs no change anywhere else:
+//
+//   REGISTER_KERNEL(naive, .name = "Naive", .run = run_naive, ...)
+#define REGISTER_KERNEL(id, ...) \
+    static const KernelInfo id##_kernel_info = { __VA_ARGS__ }; \
+    __attribute__((constructor)) static void id##_kernel_register(void) { \
+        kernel_register(&id##_kernel_info); \
+    }
+
+void kernel_register(const KernelInfo *info);
+size_t kernel_count(void);
+const KernelInfo* kernel_get(size_t index);
+const KernelInfo* kernel_find(const char *name);
+
+// Case-insensitive match of a name against a pattern with * and ? wildcards
+int kernel_name_matches(const char *pattern, const char *name);
+
+// Select the kernels matching any comma-separated name or glob in list, in
+// report order; NULL or "" selects every kernel. Patterns that match
+// nothing are copied, comma-separated, to unmatched. Returns the count.
+size_t kernel_select(const char *list, const KernelInfo **out, size_t max,
+                     char *unmatched, size_t unmatched_len);
+
+void print_kernel_list(FILE *out);
+
+#endif // KERNEL_REGISTRY_H
@@ -8,14 +8,28 @@ typedef struct {
     double *data;
     size_t rows;
     size_t cols;
+    int prefaulted;     // data came from prefaulted_malloc
 } Matrix;
 
 // Matrix allocation and deallocation
 Matrix* matrix_create(size_t rows, size_t cols);
+Matrix* matrix_create_prefaulted(size_t rows, size_t cols);
 void matrix_destroy(Matrix *mat);
 void matrix_init_random(Matrix *mat, double min, double max);
 void matrix_init_zero(Matrix *mat);
 
+// Distance in k iterations of the software prefetches in the tiled and
+// vector kernels, 0 for none (--prefetch)
+extern size_t matrix_prefetch_distance;
+
+// Independent FMA chains that keep the FMA units busy, from the machine
+// profile (--probe), 0 when unknown. Register blocks with fewer accumulators
+// wait on FMA latency.
+extern int matrix_fma_chains;
+
+// k below which k + dist is one of reach rows still ahead; 0 with dist 0
+#define PREFETCH_END(dist, reach) ((dist) && (dist) < (reach) ? (reach) - (dist) : 0)
+
 // Matrix access macros
 #define MATRIX_GET(mat, i, j) ((mat)->data[(i) * (mat)->cols + (j)])
 #define MATRIX_SET(mat, i, j, val) ((mat)->data[(i) * (mat)->cols + (j)] = (val))
@@ -23,14 +37,39 @@ void matrix_init_zero(Matrix *mat);
 // Matrix multiplication implementations
 void matrix_mult_naive(const Matrix *A, const Matrix *B, Matrix *C);
 void matrix_mult_tiled(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_size);
+// matrix_mult_tiled on a 4 x 4 software-pipelined register-blocked micro-kernel
+void matrix_mult_tiled_register(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_size);
+void matrix_mult_tiled_optimized(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_size);
+// Row i of an ikj update, prefetching matrix_prefetch_distance k ahead while k < pf_end
+void matrix_tile_row_prefetched(const Matrix *A, const Matrix *B, Matrix *C, size_t i, size_t kk,
+                                size_t k_end, size_t jj, size_t j_end, size_t pf_end);
+void matrix_mult_tiled_parallel(const Matrix *A, const Matrix *B, Matrix *C,
+                                size_t tile_size, int num_threads);
 
 #ifdef USE_VECTOR
 void matrix_mult_vector(const Matrix *A, const Matrix *B, Matrix *C);
+void matrix_mult_vector_optimized(const Matrix *A, const Matrix *B, Matrix *C);
+// C = A * B with B given transposed, Bt (p x m), as a column-major B arrives
+void matrix_mult_vector_bt(const Matrix *A, const Matrix *Bt, Matrix *C);
+void matrix_mult_rvv(const Matrix *A, const Matrix *B, Matrix *C);
+// Register-blocked RVV kernel at LMUL 1, 2, 4 or 8; 0 picks one for the shape
+void matrix_mult_rvv_lmul(const Matrix *A, const Matrix *B, Matrix *C, int lmul);
+int rvv_select_lmul(size_t rows, size_t cols);
+void matrix_mult_rvv_bt(const Matrix *A, const Matrix *Bt, Matrix *C, int lmul);
 #endif
 
+// Power-of-two tile whose A, B and C blocks fit in a quarter of cache_size_bytes
+size_t calculate_optimal_tile_size(size_t cache_size_bytes, size_t element_size);
+
 // Verification function
 int matrix_verify(const Matrix *A, const Matrix *B, double tolerance);
 
+// dst (cols x rows of src) = src transposed
+void matrix_transpose(const Matrix *src, Matrix *dst);
+
+// FNV-1a hash of the element bits, equal only for bit-identical results
+unsigned long long matrix_checksum(const Matrix *mat);
+
 // Default tile size for cache-aware implementation
 #define DEFAULT_TILE_SIZE 64
 
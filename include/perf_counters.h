@@ -0,0 +1,62 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "benchmark.h"
+
+// Hardware events counted around each kernel invocation
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NUM_COUNTERS
+} PerfCounterId;
+
+// Counter values for one timed iteration; scaled when the PMU multiplexed
+typedef struct {
+    uint64_t values[PERF_NUM_COUNTERS];
+    unsigned valid_mask;    // Bit i set when values[i] was counted
+} PerfSample;
+
+// One perf_event_open group led by the cycle counter, inherited by the
+// threads the calling thread creates while it is open
+typedef struct {
+    int fds[PERF_NUM_COUNTERS];
+    uint64_t start[PERF_NUM_COUNTERS][3];  // value, time enabled, time running at start
+    unsigned open_mask;
+    char error[128];        // Why counters are unavailable, if they are
+} PerfCounters;
+
+// Collects a PerfSample for every timed iteration through a BenchHook
+typedef struct {
+    PerfCounters *counters;
+    PerfSample *samples;
+    size_t count;
+    size_t capacity;
+    BenchHook hook;
+} PerfRecorder;
+
+// Returns 0 when at least the cycle counter could be opened
+int perf_counters_open(PerfCounters *pc);
+void perf_counters_close(PerfCounters *pc);
+void perf_counters_start(PerfCounters *pc);
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample);
+const char* perf_counter_name(PerfCounterId id);
+
+void perf_recorder_init(PerfRecorder *rec, PerfCounters *pc);
+void perf_recorder_reset(PerfRecorder *rec);
+void perf_recorder_free(PerfRecorder *rec);
+
+// Average counters over samples; mask is the set of counters valid in all of them
+unsigned perf_samples_mean(const PerfSample *samples, size_t count, double *mean);
+
+void print_counters_header(FILE *out);
+void print_counters_result(FILE *out, const char *method, size_t matrix_size,
+                           const PerfSample *samples, size_t count);
+
+#endif // PERF_COUNTERS_H
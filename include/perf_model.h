@@ -0,0 +1,87 @@
+#ifndef PERF_MODEL_H
+#define PERF_MODEL_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "roofline.h"
+#include "uarch_probe.h"
+
+// Blocking of a GEMM in the GotoBLAS loop order: NC columns of B, KC-deep
+// panels and MC rows of A, with an MR x NR block of C kept in registers for
+// KR steps of k (KR = KC for a register-blocked micro-kernel, 1 when C is
+// read and written for every k). Threads split the rows of C.
+typedef struct {
+    size_t mc, kc, nc;
+    size_t mr, nr, kr;
+    int threads;
+} ModelBlocking;
+
+// Blocking a kernel effectively uses for an n x n product at this tile
+typedef void (*model_blocking_fn)(size_t n, size_t tile, int threads, ModelBlocking *out);
+
+// Ceilings of one core; L1 and L2 bandwidth scale with threads, shared
+// levels do not
+typedef struct {
+    double peak_gflops;
+    double fma_latency_ns;                  // 0 when unknown
+    double load_latency_ns;                 // L1 load-to-use, 0 when unknown
+    double bandwidth_gbs[ROOF_NUM_LEVELS];
+    size_t cache_bytes[UARCH_MAX_LEVELS];   // 0 when a level is absent
+} ModelMachine;
+
+typedef struct {
+    double bytes[ROOF_NUM_LEVELS];          // Loads served by each level
+    double level_seconds[ROOF_NUM_LEVELS];
+    double compute_seconds;                 // Peak FLOPS or FMA latency, whichever is slower
+    double transfer_seconds;                // All levels, one after another
+    double seconds;                         // Compute, or all transfers if longer
+    int bound;                              // Costliest RoofLevel, MODEL_BOUND_COMPUTE or
+                                            // MODEL_BOUND_LATENCY
+} ModelPrediction;
+
+#define MODEL_BOUND_COMPUTE (-1)
+#define MODEL_BOUND_LATENCY (-2)
+
+// One measured configuration and what the model made of it
+typedef struct {
+    const char *kernel;
+    model_blocking_fn blocking;
+    size_t size;
+    size_t tile;
+    int threads;
+    double measured;
+    ModelPrediction predicted;
+} ModelPoint;
+
+typedef struct {
+    const ModelMachine *machine;
+    ModelPoint *points;
+    size_t count;
+    size_t capacity;
+} ModelValidation;
+
+// Returns -1 when the profile predates the stored ceilings
+int model_machine_from_profile(ModelMachine *mm, const UarchProfile *profile);
+// Measures the ceilings now, with sysfs cache sizes and no FMA latency
+int model_machine_measure(ModelMachine *mm, double seconds_per_test);
+
+void model_predict(const ModelMachine *mm, size_t m, size_t n, size_t k,
+                   const ModelBlocking *blocking, ModelPrediction *out);
+
+// Tile (a multiple of 8 up to n, at most 512) with the lowest predicted time,
+// then the least predicted transfer time
+size_t model_plan_tile(const ModelMachine *mm, model_blocking_fn blocking, size_t n,
+                       int threads, ModelPrediction *out);
+
+const char* model_bound_name(int bound);
+
+void model_validation_init(ModelValidation *v, const ModelMachine *mm);
+int model_validation_add(ModelValidation *v, const char *kernel, model_blocking_fn blocking,
+                         size_t size, size_t tile, int threads, double measured_seconds);
+void model_validation_free(ModelValidation *v);
+
+// Per-point error, mean absolute error, and per kernel and size the tile
+// the model would pick against the fastest measured one
+void print_model_validation(FILE *out, const ModelValidation *v);
+
+#endif // PERF_MODEL_H
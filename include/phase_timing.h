@@ -0,0 +1,67 @@
+#ifndef PHASE_TIMING_H
+#define PHASE_TIMING_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "benchmark.h"
+
+// Phases a kernel call is broken down into
+typedef enum {
+    PHASE_ZERO,         // Clearing C
+    PHASE_PACK_A,       // Copying A panels into contiguous buffers
+    PHASE_PACK_B,
+    PHASE_MICRO_KERNEL, // Multiply-accumulate loops
+    PHASE_EPILOGUE,     // Writing results back to C
+    PHASE_SYNC,         // Waiting at barriers / joins
+    PHASE_NUM_PHASES
+} PhaseId;
+
+// Time and bytes touched per phase, summed over every instrumented region
+typedef struct {
+    uint64_t ns[PHASE_NUM_PHASES];
+    uint64_t bytes[PHASE_NUM_PHASES];
+    uint64_t calls[PHASE_NUM_PHASES];
+} PhaseTotals;
+
+// Instrumentation points for kernels. They compile to nothing unless the
+// build defines ENABLE_PHASE_TIMING (make PHASE_TIMING=1), so the timed
+// kernels are unchanged in normal builds.
+#ifdef ENABLE_PHASE_TIMING
+#define PHASE_TIMING_ENABLED 1
+#define PHASE_BEGIN(mark) uint64_t mark = phase_clock_ns()
+#define PHASE_END(mark, phase, nbytes) \
+    phase_record((phase), (mark), phase_clock_ns(), (uint64_t)(nbytes))
+#else
+#define PHASE_TIMING_ENABLED 0
+#define PHASE_BEGIN(mark) ((void)0)
+#define PHASE_END(mark, phase, nbytes) ((void)0)
+#endif
+
+// Operand bytes touched by an rows x cols x depth block: the A and B
+// panels once, the C block read and written
+#define TILE_FOOTPRINT_BYTES(rows, cols, depth) \
+    (((rows) * (depth) + (depth) * (cols) + 2 * (rows) * (cols)) * sizeof(double))
+
+uint64_t phase_clock_ns(void);
+// Thread-safe; also emits a trace event while tracing is active
+void phase_record(PhaseId phase, uint64_t begin_ns, uint64_t end_ns, uint64_t bytes);
+void phase_totals_reset(void);
+void phase_totals_snapshot(PhaseTotals *totals);
+const char* phase_name(PhaseId phase);
+
+// Sums the per-phase totals of every timed iteration through a BenchHook
+typedef struct {
+    PhaseTotals sum;
+    double sample_seconds;  // Wall time of the recorded samples
+    size_t samples;
+    BenchHook hook;
+} PhaseRecorder;
+
+void phase_recorder_init(PhaseRecorder *rec);
+void phase_recorder_reset(PhaseRecorder *rec);
+
+void print_phase_header(FILE *out);
+void print_phase_breakdown(FILE *out, const char *method, const PhaseRecorder *rec);
+
+#endif // PHASE_TIMING_H
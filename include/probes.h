@@ -0,0 +1,40 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+// USDT static probes (provider "matrix_mult") for attaching perf probe or
+// bpftrace to a running process. With sys/sdt.h (systemtap-sdt-dev) each
+// probe is a single nop plus an ELF note; without it, or with -DNO_USDT,
+// the probes compile to nothing.
+//
+//   kernel_entry(name, rows, inner, cols)   kernel_exit(name, rows, inner, cols)
+//   tile_start(i, j, k)                     tile_end(i, j, k)
+//   pack_start(matrix, rows, cols)          pack_end(matrix, rows, cols)
+//
+// List them with: make list-probes
+#if !defined(NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define HAVE_USDT 1
+#endif
+#endif
+
+#ifdef HAVE_USDT
+#include <sys/sdt.h>
+#define USDT_ENABLED 1
+
+#define PROBE_KERNEL_ENTRY(name, n, m, p) DTRACE_PROBE4(matrix_mult, kernel_entry, name, n, m, p)
+#define PROBE_KERNEL_EXIT(name, n, m, p)  DTRACE_PROBE4(matrix_mult, kernel_exit, name, n, m, p)
+#define PROBE_TILE_START(i, j, k)         DTRACE_PROBE3(matrix_mult, tile_start, i, j, k)
+#define PROBE_TILE_END(i, j, k)           DTRACE_PROBE3(matrix_mult, tile_end, i, j, k)
+#define PROBE_PACK_START(which, r, c)     DTRACE_PROBE3(matrix_mult, pack_start, which, r, c)
+#define PROBE_PACK_END(which, r, c)       DTRACE_PROBE3(matrix_mult, pack_end, which, r, c)
+#else
+#define USDT_ENABLED 0
+#define PROBE_KERNEL_ENTRY(name, n, m, p) ((void)0)
+#define PROBE_KERNEL_EXIT(name, n, m, p)  ((void)0)
+#define PROBE_TILE_START(i, j, k)         ((void)0)
+#define PROBE_TILE_END(i, j, k)           ((void)0)
+#define PROBE_PACK_START(which, r, c)     ((void)0)
+#define PROBE_PACK_END(which, r, c)       ((void)0)
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,63 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "benchmark.h"
+#include "perf_counters.h"
+#include "freq_monitor.h"
+
+// Output formats for benchmark results
+typedef enum {
+    REPORT_TABLE,
+    REPORT_CSV,
+    REPORT_JSON
+} ReportFormat;
+
+// Build and host metadata attached to every result
+typedef struct {
+    char cpu_model[128];
+    const char *isa;
+    const char *compiler;
+    const char *cflags;
+    long processors;
+    size_t l1_cache;
+    size_t l2_cache;
+    size_t l3_cache;
+} ReportEnv;
+
+// Configuration of one benchmarked kernel run
+typedef struct {
+    const char *kernel;
+    size_t size;
+    size_t tile;
+    int threads;
+    const PerfSample *counters; // One per sample, or NULL when not collected
+    const double *energy_joules; // One per sample, or NULL when not measured
+    const FreqSample *freq;     // One per sample, or NULL when not monitored
+} ReportRecord;
+
+// Streaming writer; records are emitted as soon as a kernel finishes
+typedef struct {
+    ReportFormat format;
+    FILE *out;
+    ReportEnv env;
+    size_t kernels_written;
+} Report;
+
+int report_parse_format(const char *name, ReportFormat *format);
+const char* report_format_name(ReportFormat format);
+void report_env_collect(ReportEnv *env);
+
+void report_begin(Report *report, ReportFormat format, FILE *out, const BenchConfig *cfg);
+void report_kernel(Report *report, const ReportRecord *record, const BenchResult *result);
+void report_end(Report *report);
+
+// Column header of the CSV format, shared with readers of result files
+#define REPORT_CSV_HEADER \
+    "kernel,size,tile,threads,isa,iteration,time_ms,gflops," \
+    "cpu_model,compiler,cflags,l1_cache,l2_cache,l3_cache," \
+    "cycles,instructions,l1d_misses,llc_misses,dtlb_misses,branch_misses," \
+    "energy_j,freq_mhz,max_temp_c,stable"
+
+#endif // REPORT_H
@@ -0,0 +1,60 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Memory levels for which sustained bandwidth is measured
+typedef enum {
+    ROOF_L1,
+    ROOF_L2,
+    ROOF_L3,
+    ROOF_DRAM,
+    ROOF_NUM_LEVELS
+} RoofLevel;
+
+// Measured machine ceilings
+typedef struct {
+    double peak_gflops;                     // Register-only FMA throughput
+    double bandwidth_gbs[ROOF_NUM_LEVELS];  // STREAM triad, best of several runs
+    size_t working_set[ROOF_NUM_LEVELS];    // Bytes streamed for each level
+} RoofMachine;
+
+// Traffic model of a kernel: bytes moved past a cache of cache_bytes
+typedef double (*roof_traffic_fn)(size_t n, size_t tile, size_t cache_bytes);
+
+// Where one kernel sits against the DRAM roof
+typedef struct {
+    const char *kernel;
+    size_t size;
+    size_t tile;
+    double flops;
+    double dram_bytes;
+    double intensity;       // FLOPs per DRAM byte
+    double gflops;          // Measured
+    double roof_gflops;     // min(peak, intensity * DRAM bandwidth)
+    int memory_bound;       // Roof set by bandwidth rather than peak FLOPS
+} RoofPoint;
+
+// Measurement
+int roofline_measure(RoofMachine *machine, double seconds_per_test);
+double roofline_measure_peak(double seconds);
+double roofline_measure_bandwidth(size_t bytes, double seconds);
+
+// Traffic models for the kernels in this project
+double roofline_traffic_naive(size_t n, size_t tile, size_t cache_bytes);
+double roofline_traffic_tiled(size_t n, size_t tile, size_t cache_bytes);
+double roofline_traffic_vector(size_t n, size_t tile, size_t cache_bytes);
+
+void roofline_point(const RoofMachine *machine, const char *kernel, size_t n, size_t tile,
+                    roof_traffic_fn traffic, double measured_seconds, RoofPoint *point);
+const char* roofline_level_name(RoofLevel level);
+
+// Reporting
+void print_roofline_machine(FILE *out, const RoofMachine *machine);
+void print_roofline_header(FILE *out);
+void print_roofline_point(FILE *out, const RoofPoint *point);
+void write_roofline_csv(FILE *out, const RoofMachine *machine,
+                        const RoofPoint *points, size_t count);
+
+#endif // ROOFLINE_H
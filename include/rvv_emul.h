@@ -0,0 +1,254 @@
+#ifndef RVV_EMUL_H
+#define RVV_EMUL_H
+
+// RVV intrinsics for kernels written once against <riscv_vector.h> (v1.0
+// names, __riscv_ prefix). Builds with the V extension get the real
+// header; everywhere else this file emulates the subset the kernels use on
+// RVV_EMUL_VLEN-bit registers, with AVX doing the arithmetic when it is
+// available:
+//
+//   __riscv_vlenb, vsetvl_e64, vsetvlmax_e64     vle64, vse64, vlse64
+//   vluxei64, vloxei64 (byte offsets)            vfmacc_vf, vfmacc_vv
+//   vfmv_v_f, vfmv_s_f, vfmv_f_s                 vfredusum_vs, vfredosum_vs
+//   vid_v, vmul_vx, vadd_vx (u64)                vlseg8e64, vlsseg8e64, vget (m1x8)
+//
+// for f64 and u64 elements at LMUL m1, m2, m4 and m8, unmasked. Results are
+// bit-identical to qemu-riscv64: vsetvl returns min(AVL, VLMAX), vfmacc is
+// fused and both reductions add in element order from the scalar operand,
+// as QEMU does. Tail elements of the emulated registers are left as they
+// were or zeroed, which the tail-agnostic policy allows.
+#if defined(__riscv_vector)
+
+#include <riscv_vector.h>
+#define RVV_EMULATED 0
+
+#else
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+
+#define RVV_EMULATED 1
+
+#if RVV_EMUL_VLEN < 64 || RVV_EMUL_VLEN > 65536 || (RVV_EMUL_VLEN & (RVV_EMUL_VLEN - 1)) != 0
+#error "RVV_EMUL_VLEN must be a power of two from 64 to 65536"
+#endif
+
+// 8-lane AVX-512 first, then 4-lane AVX, then scalar fma()
+#if defined(__AVX512F__) || (defined(__AVX__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+// Keeps -ffast-math from reassociating the ordered reductions
+#if defined(__x86_64__) || defined(__i386__)
+#define RVV_EMUL_FP_BARRIER(v) __asm__ volatile("" : "+x"(v))
+#elif defined(__aarch64__)
+#define RVV_EMUL_FP_BARRIER(v) __asm__ volatile("" : "+w"(v))
+#else
+#define RVV_EMUL_FP_BARRIER(v) __asm__ volatile("" : "+m"(v))
+#endif
+
+// Element-wise helpers shared by every LMUL. vlmax is the compile-time
+// register length: vl never exceeds it, and AVX loops wider than the register
+// compile away.
+static inline void rvv_emul_fmacc_vf(double *vd, double rs1, const double *vs2, size_t vl,
+                                     size_t vlmax) {
+    size_t i = 0;
+    if (vl > vlmax) vl = vlmax;
+#if defined(__AVX512F__)
+    for (; vlmax >= 8 && i + 8 <= vl; i += 8) {
+        _mm512_storeu_pd(vd + i, _mm512_fmadd_pd(_mm512_set1_pd(rs1), _mm512_loadu_pd(vs2 + i),
+                                                 _mm512_loadu_pd(vd + i)));
+    }
+#endif
+#if defined(__AVX__) && defined(__FMA__)
+    for (; vlmax >= 4 && i + 4 <= vl; i += 4) {
+        _mm256_storeu_pd(vd + i, _mm256_fmadd_pd(_mm256_set1_pd(rs1), _mm256_loadu_pd(vs2 + i),
+                                                 _mm256_loadu_pd(vd + i)));
+    }
+#endif
+    for (; i < vl; i++) vd[i] = fma(rs1, vs2[i], vd[i]);
+}
+
+static inline void rvv_emul_fmacc_vv(double *vd, const double *vs1, const double *vs2, size_t vl,
+                                     size_t vlmax) {
+    size_t i = 0;
+    if (vl > vlmax) vl = vlmax;
+#if defined(__AVX512F__)
+    for (; vlmax >= 8 && i + 8 <= vl; i += 8) {
+        _mm512_storeu_pd(vd + i, _mm512_fmadd_pd(_mm512_loadu_pd(vs1 + i), _mm512_loadu_pd(vs2 + i),
+                                                 _mm512_loadu_pd(vd + i)));
+    }
+#endif
+#if defined(__AVX__) && defined(__FMA__)
+    for (; vlmax >= 4 && i + 4 <= vl; i += 4) {
+        _mm256_storeu_pd(vd + i, _mm256_fmadd_pd(_mm256_loadu_pd(vs1 + i), _mm256_loadu_pd(vs2 + i),
+                                                 _mm256_loadu_pd(vd + i)));
+    }
+#endif
+    for (; i < vl; i++) vd[i] = fma(vs1[i], vs2[i], vd[i]);
+}
+
+static inline double rvv_emul_ordered_sum(double sum, const double *v, size_t vl) {
+    for (size_t i = 0; i < vl; i++) {
+        sum += v[i];
+        RVV_EMUL_FP_BARRIER(sum);
+    }
+    return sum;
+}
+
+// Types and intrinsics of one LMUL; VLMAX is VLEN / 64 * LMUL elements.
+// Full-length loads and stores use constant trip counts the compiler turns
+// into vector moves.
+#define RVV_EMUL_DEFINE_LMUL(lmul, mult)                                                  \
+    enum { RVV_EMUL_VLMAX_##lmul = RVV_EMUL_VLEN / 64 * (mult) };                         \
+    typedef struct { double e[RVV_EMUL_VLMAX_##lmul]; } vfloat64##lmul##_t;               \
+    typedef struct { uint64_t e[RVV_EMUL_VLMAX_##lmul]; } vuint64##lmul##_t;              \
+                                                                                          \
+    static inline size_t __riscv_vsetvlmax_e64##lmul(void) {                              \
+        return RVV_EMUL_VLMAX_##lmul;                                                     \
+    }                                                                                     \
+    static inline size_t __riscv_vsetvl_e64##lmul(size_t avl) {                           \
+        return avl < RVV_EMUL_VLMAX_##lmul ? avl : RVV_EMUL_VLMAX_##lmul;                 \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vle64_v_f64##lmul(const double *base,        \
+                                                               size_t vl) {               \
+        vfloat64##lmul##_t v = {{0}};                                                     \
+        if (vl == RVV_EMUL_VLMAX_##lmul) {                                                \
+            for (size_t i = 0; i < RVV_EMUL_VLMAX_##lmul; i++) v.e[i] = base[i];          \
+        } else {                                                                          \
+            memcpy(v.e, base, vl * sizeof(double));                                       \
+        }                                                                                 \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline void __riscv_vse64_v_f64##lmul(double *base, vfloat64##lmul##_t value,  \
+                                                 size_t vl) {                             \
+        if (vl == RVV_EMUL_VLMAX_##lmul) {                                                \
+            for (size_t i = 0; i < RVV_EMUL_VLMAX_##lmul; i++) base[i] = value.e[i];      \
+        } else {                                                                          \
+            memcpy(base, value.e, vl * sizeof(double));                                   \
+        }                                                                                 \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vlse64_v_f64##lmul(const double *base,       \
+                                                                ptrdiff_t bstride,        \
+                                                                size_t vl) {              \
+        vfloat64##lmul##_t v = {{0}};                                                     \
+        const char *p = (const char *)base;                                               \
+        for (size_t i = 0; i < vl; i++) memcpy(&v.e[i], p + (ptrdiff_t)i * bstride, 8);   \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vluxei64_v_f64##lmul(const double *base,     \
+                                                                  vuint64##lmul##_t bindex, \
+                                                                  size_t vl) {            \
+        vfloat64##lmul##_t v = {{0}};                                                     \
+        const char *p = (const char *)base;                                               \
+        for (size_t i = 0; i < vl; i++) memcpy(&v.e[i], p + bindex.e[i], 8);              \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vloxei64_v_f64##lmul(const double *base,     \
+                                                                  vuint64##lmul##_t bindex, \
+                                                                  size_t vl) {            \
+        return __riscv_vluxei64_v_f64##lmul(base, bindex, vl);                            \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vfmacc_vf_f64##lmul(vfloat64##lmul##_t vd,   \
+                                                                 double rs1,              \
+                                                                 vfloat64##lmul##_t vs2,  \
+                                                                 size_t vl) {             \
+        rvv_emul_fmacc_vf(vd.e, rs1, vs2.e, vl, RVV_EMUL_VLMAX_##lmul);                   \
+        return vd;                                                                        \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vfmacc_vv_f64##lmul(vfloat64##lmul##_t vd,   \
+                                                                 vfloat64##lmul##_t vs1,  \
+                                                                 vfloat64##lmul##_t vs2,  \
+                                                                 size_t vl) {             \
+        rvv_emul_fmacc_vv(vd.e, vs1.e, vs2.e, vl, RVV_EMUL_VLMAX_##lmul);                 \
+        return vd;                                                                        \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vfmv_v_f_f64##lmul(double rs1, size_t vl) {  \
+        vfloat64##lmul##_t v = {{0}};                                                     \
+        for (size_t i = 0; i < vl; i++) v.e[i] = rs1;                                     \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vfmv_s_f_f64##lmul(double rs1, size_t vl) {  \
+        vfloat64##lmul##_t v = {{0}};                                                     \
+        if (vl > 0) v.e[0] = rs1;                                                         \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline double __riscv_vfmv_f_s_f64##lmul##_f64(vfloat64##lmul##_t vs1) {       \
+        return vs1.e[0];                                                                  \
+    }                                                                                     \
+    static inline vuint64##lmul##_t __riscv_vid_v_u64##lmul(size_t vl) {                  \
+        vuint64##lmul##_t v = {{0}};                                                      \
+        for (size_t i = 0; i < vl; i++) v.e[i] = i;                                       \
+        return v;                                                                         \
+    }                                                                                     \
+    static inline vuint64##lmul##_t __riscv_vmul_vx_u64##lmul(vuint64##lmul##_t op1,      \
+                                                              uint64_t op2, size_t vl) {  \
+        for (size_t i = 0; i < vl; i++) op1.e[i] *= op2;                                  \
+        return op1;                                                                       \
+    }                                                                                     \
+    static inline vuint64##lmul##_t __riscv_vadd_vx_u64##lmul(vuint64##lmul##_t op1,      \
+                                                              uint64_t op2, size_t vl) {  \
+        for (size_t i = 0; i < vl; i++) op1.e[i] += op2;                                  \
+        return op1;                                                                       \
+    }
+
+// Reductions of any LMUL into element 0 of an m1 register
+#define RVV_EMUL_DEFINE_REDUCTIONS(lmul)                                                  \
+    static inline vfloat64m1_t __riscv_vfredusum_vs_f64##lmul##_f64m1(                    \
+            vfloat64##lmul##_t vector, vfloat64m1_t scalar, size_t vl) {                  \
+        scalar.e[0] = rvv_emul_ordered_sum(scalar.e[0], vector.e, vl);                    \
+        return scalar;                                                                    \
+    }                                                                                     \
+    static inline vfloat64m1_t __riscv_vfredosum_vs_f64##lmul##_f64m1(                    \
+            vfloat64##lmul##_t vector, vfloat64m1_t scalar, size_t vl) {                  \
+        return __riscv_vfredusum_vs_f64##lmul##_f64m1(vector, scalar, vl);                \
+    }
+
+// Segment loads of nf fields into a tuple of nf registers: field f of
+// element i comes from base + i * bstride + f (unit stride: bstride is the
+// segment size). vget indices are constants on real hardware.
+#define RVV_EMUL_DEFINE_SEGMENT(lmul, nf)                                                 \
+    typedef struct { vfloat64##lmul##_t v[nf]; } vfloat64##lmul##x##nf##_t;              \
+                                                                                          \
+    static inline vfloat64##lmul##x##nf##_t __riscv_vlsseg##nf##e64_v_f64##lmul##x##nf(   \
+            const double *base, ptrdiff_t bstride, size_t vl) {                           \
+        vfloat64##lmul##x##nf##_t t = {{{{0}}}};                                          \
+        const char *p = (const char *)base;                                               \
+        if (vl > RVV_EMUL_VLMAX_##lmul) vl = RVV_EMUL_VLMAX_##lmul;                       \
+        for (size_t i = 0; i < vl; i++) {                                                 \
+            const double *seg = (const double *)(p + (ptrdiff_t)i * bstride);             \
+            for (size_t f = 0; f < (nf); f++) memcpy(&t.v[f].e[i], seg + f, 8);           \
+        }                                                                                 \
+        return t;                                                                         \
+    }                                                                                     \
+    static inline vfloat64##lmul##x##nf##_t __riscv_vlseg##nf##e64_v_f64##lmul##x##nf(    \
+            const double *base, size_t vl) {                                              \
+        return __riscv_vlsseg##nf##e64_v_f64##lmul##x##nf(base, (nf) * sizeof(double), vl); \
+    }                                                                                     \
+    static inline vfloat64##lmul##_t __riscv_vget_v_f64##lmul##x##nf##_f64##lmul(         \
+            vfloat64##lmul##x##nf##_t tuple, size_t index) {                              \
+        return tuple.v[index];                                                            \
+    }
+
+static inline size_t __riscv_vlenb(void) {
+    return RVV_EMUL_VLEN / 8;
+}
+
+RVV_EMUL_DEFINE_LMUL(m1, 1)
+RVV_EMUL_DEFINE_LMUL(m2, 2)
+RVV_EMUL_DEFINE_LMUL(m4, 4)
+RVV_EMUL_DEFINE_LMUL(m8, 8)
+
+RVV_EMUL_DEFINE_REDUCTIONS(m1)
+RVV_EMUL_DEFINE_REDUCTIONS(m2)
+RVV_EMUL_DEFINE_REDUCTIONS(m4)
+RVV_EMUL_DEFINE_REDUCTIONS(m8)
+
+RVV_EMUL_DEFINE_SEGMENT(m1, 8)
+
+#endif // __riscv_vector
+
+#endif // RVV_EMUL_H
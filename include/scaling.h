@@ -0,0 +1,58 @@
+#ifndef SCALING_H
+#define SCALING_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef enum {
+    SCALING_STRONG,     // Fixed total work, more threads
+    SCALING_WEAK        // Fixed work per thread, size grows with threads
+} ScalingMode;
+
+// One kernel run at one thread count
+typedef struct {
+    ScalingMode mode;
+    const char *kernel;
+    int threads;
+    size_t size;
+    size_t tile;
+    double seconds;         // Median time
+    double gflops;
+    double speedup;         // Strong: T1/Tp; weak: GFLOPS relative to 1 thread
+    double efficiency;      // speedup / threads
+    double kernel_gbs;      // Modelled DRAM traffic over the median time
+    double stream_gbs;      // Threaded STREAM triad at this thread count
+} ScalingPoint;
+
+// Triad arrays shared by all thread counts
+typedef struct {
+    double *a;
+    double *b;
+    double *c;
+    size_t n;
+} ScalingStream;
+
+// Matrix size giving threads times the work of base (2n^3 FLOPs)
+size_t scaling_weak_size(size_t base, int threads);
+
+// bytes == 0 picks four times the last-level cache, as the roofline does
+int scaling_stream_init(ScalingStream *stream, size_t bytes);
+void scaling_stream_free(ScalingStream *stream);
+double scaling_stream_measure(ScalingStream *stream, int threads, double seconds);
+
+// Fill speedup and efficiency relative to the 1-thread point of each mode
+void scaling_finish(ScalingPoint *points, size_t count);
+
+// Index of the first point of mode whose triad bandwidth is within
+// fraction of the best, or -1 when there is none
+int scaling_saturation(const ScalingPoint *points, size_t count, ScalingMode mode,
+                       double fraction);
+
+const char* scaling_mode_name(ScalingMode mode);
+
+// Reporting
+void print_scaling_header(FILE *out);
+void print_scaling_point(FILE *out, const ScalingPoint *point);
+void write_scaling_csv(FILE *out, const ScalingPoint *points, size_t count);
+
+#endif // SCALING_H
@@ -0,0 +1,41 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "benchmark.h"
+
+#define SWEEP_MAX_VALUES 256
+
+// Cartesian product of configurations run in one process. Lists left empty
+// are filled from the single-run options by sweep_spec_defaults().
+typedef struct {
+    size_t sizes[SWEEP_MAX_VALUES];
+    size_t num_sizes;
+    size_t tiles[SWEEP_MAX_VALUES];
+    size_t num_tiles;
+    int threads[SWEEP_MAX_VALUES];
+    size_t num_threads;
+    char kernels[256];      // Comma-separated names or globs, "" for all
+    char error[128];
+} SweepSpec;
+
+void sweep_spec_init(SweepSpec *spec);
+
+// Parse whitespace-separated "key=values" items, where key is sizes, tiles,
+// threads or kernels and values is a comma list of numbers, kernel names
+// or globs, or START:END:STEP ranges (inclusive). Returns 0 on success.
+int sweep_parse(SweepSpec *spec, const char *text);
+
+// True when arg looks like a key=values item, so it can follow --sweep
+int sweep_is_item(const char *arg);
+
+void sweep_spec_defaults(SweepSpec *spec, size_t size, size_t tile, int threads);
+size_t sweep_max_size(const SweepSpec *spec);
+
+// Reporting; verified is 1 (match), 0 (mismatch) or -1 (not checked)
+void print_sweep_header(FILE *out);
+void print_sweep_result(FILE *out, const char *kernel, size_t size, size_t tile,
+                        int threads, const BenchResult *result, int verified);
+
+#endif // SWEEP_H
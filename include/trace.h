@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "config.h"
+#include "benchmark.h"
+#include "phase_timing.h"
+
+// Events kept per thread; older events are overwritten when a ring is full
+#define TRACE_RING_EVENTS 65536
+
+// One complete ("X") event in Chrome trace terms
+typedef struct {
+    const char *name;       // Must outlive the trace (string literals)
+    const char *category;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    long arg;               // Emitted as args.index when >= 0
+} TraceEvent;
+
+// Tracing is off unless trace_start() was called. Instrumentation points
+// cost one predictable branch on trace_active when it is off.
+extern int trace_active;
+#define TRACE_ENABLED() UNLIKELY(trace_active)
+
+#define TRACE_BEGIN(mark) uint64_t mark = TRACE_ENABLED() ? phase_clock_ns() : 0
+#define TRACE_END(mark, name, category, arg) \
+    do { \
+        if (TRACE_ENABLED()) trace_complete((name), (category), (mark), phase_clock_ns(), (arg)); \
+    } while (0)
+
+// Enable tracing and write Chrome trace JSON to path at exit
+int trace_start(const char *path);
+int trace_write(FILE *out);
+
+// Events go to the ring of the calling thread's trace id (0 by default).
+// Worker threads set a distinct id before recording; an id must not be
+// used by two threads at once.
+void trace_set_thread(int tid);
+void trace_complete(const char *name, const char *category,
+                    uint64_t begin_ns, uint64_t end_ns, long arg);
+
+// Records every timed benchmark sample as an event named after the kernel
+typedef struct {
+    const char *name;
+    uint64_t begin_ns;
+    BenchHook hook;
+} TraceSampleHook;
+
+void trace_sample_hook_init(TraceSampleHook *th);
+
+#endif // TRACE_H
@@ -0,0 +1,42 @@
+#ifndef UARCH_PROBE_H
+#define UARCH_PROBE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "roofline.h"
+
+#define UARCH_MAX_LEVELS 3
+
+// Machine parameters measured by microbenchmarks rather than read from
+// sysfs, plus the blocking chosen from them
+typedef struct {
+    char cpu_model[128];
+    double clock_ghz;               // From a dependent integer add chain
+    double fma_latency;             // Cycles through one dependent FMA chain
+    double fma_per_cycle;           // Scalar FMAs per cycle with enough chains
+    int fma_chains;                 // Independent chains that reach that rate
+    size_t line_size;               // Bytes, 0 when not detected
+    size_t cache_bytes[UARCH_MAX_LEVELS];   // Data cache capacities, 0 when not detected
+    double cache_latency_ns[UARCH_MAX_LEVELS];
+    int cache_levels;
+    int fp_registers;               // Architectural FP registers of this build
+    size_t tile_size;               // Tile for the cache-blocked kernels
+    double peak_gflops;             // Roofline ceilings for the performance
+    double bandwidth_gbs[ROOF_NUM_LEVELS];  // model, streamed at the measured sizes
+} UarchProfile;
+
+// Run every probe, then pick the blocking. Latency curves go to log when
+// it is not NULL. Takes a few seconds.
+int uarch_probe(UarchProfile *profile, FILE *log);
+
+// Tile sized to the measured L2 (or L1)
+void uarch_select_blocking(UarchProfile *profile);
+
+// Profiles are key = value text files. Load returns 0 on success, -1 when
+// the file is missing or malformed and 1 when it was probed on another CPU.
+int uarch_profile_save(const UarchProfile *profile, const char *path);
+int uarch_profile_load(UarchProfile *profile, const char *path);
+
+void print_uarch_profile(FILE *out, const UarchProfile *profile);
+
+#endif // UARCH_PROBE_H
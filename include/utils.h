@@ -3,6 +3,7 @@
 
 #include <time.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // Timing utilities
 typedef struct {
@@ -13,8 +14,27 @@ typedef struct {
     struct timespec start;
     struct timespec end;
 #endif
+    uint64_t start_ticks;   // Used by the cycle counter backend
+    uint64_t end_ticks;
 } Timer;
 
+// Time sources for Timer. TIMER_CYCLES reads rdcycle (falling back to
+// rdtime) on RISC-V and the TSC on x86; TIMER_CLOCK is the OS clock.
+typedef enum {
+    TIMER_CLOCK,
+    TIMER_CYCLES
+} TimerBackend;
+
+// Select a backend, calibrate its frequency and start/stop overhead.
+// Returns the backend actually in use, which is TIMER_CLOCK when the
+// cycle counter is not readable from user mode.
+TimerBackend timer_init(TimerBackend requested);
+TimerBackend timer_backend(void);
+const char* timer_backend_name(void);
+int timer_counts_core_cycles(void);
+double timer_tick_frequency(void);
+double timer_overhead_seconds(void);
+
 void timer_start(Timer *timer);
 void timer_stop(Timer *timer);
 double timer_elapsed_seconds(const Timer *timer);
@@ -29,10 +49,15 @@ void print_performance_result(const char *method, size_t matrix_size,
 // Memory utilities
 void* aligned_malloc(size_t size, size_t alignment);
 void aligned_free(void *ptr);
+void* prefaulted_malloc(size_t size);
+void prefaulted_free(void *ptr, size_t size);
 
 // System information
 void print_system_info(void);
 size_t get_cache_size(int level);
+int get_num_processors(void);
+void get_cpu_model(char *buf, size_t len);
+const char* get_isa_string(void);
 
 // Random number generation
 void seed_random(unsigned int seed);
@@ -0,0 +1,125 @@
+#!/bin/bash
+
+# Dynamic instruction mix of each kernel under qemu-riscv64
+# Runs every kernel once per VLEN with the insn_mix TCG plugin and reports
+# vector and scalar instructions, loads, stores, FMAs and branches. The counts
+# are deterministic, so a baseline can gate RISC-V changes without hardware.
+#
+# Usage: ./insn_mix.sh [-o CSV] [-b BASELINE] BINARY PLUGIN
+#   -o CSV        Write the counts to CSV (a baseline for -b)
+#   -b BASELINE   Exit with status 2 if any kernel executes more instructions
+#                 than in BASELINE by more than THRESHOLD percent
+# Environment: QEMU (qemu-riscv64), VLENS ("128 256 512"), KERNELS (every
+# kernel in the binary), SIZE (64), TILE (16), THRESHOLD (1.0)
+
+set -e
+
+QEMU=${QEMU:-qemu-riscv64}
+VLENS=${VLENS:-"128 256 512"}
+SIZE=${SIZE:-64}
+TILE=${TILE:-16}
+THRESHOLD=${THRESHOLD:-1.0}
+
+# Symbols of the kernels and the functions they call
+MATCHES="match=matrix_mult_,match=compute_panel,match=parallel_worker,match=micro_,match=matrix_tile_row_,match=tile_,match=_pack_"
+
+CSV_HEADER="kernel,vlen,size,tile,insns,vector,vsetvl,vector_loads,vector_stores,vector_fma,loads,stores,fma,fp,branches"
+
+print_error() {
+    echo "[ERROR] $1" >&2
+}
+
+usage() {
+    sed -n '3,14p' "$0" | sed 's/^# \{0,1\}//'
+    exit 1
+}
+
+output=""
+baseline=""
+while getopts "o:b:h" opt; do
+    case $opt in
+        o) output=$OPTARG ;;
+        b) baseline=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 2 ] || usage
+binary=$1
+plugin=$2
+
+if ! command -v "$QEMU" >/dev/null 2>&1; then
+    print_error "$QEMU not found (set QEMU to the user-mode emulator)"
+    exit 1
+fi
+for file in "$binary" "$plugin"; do
+    if [ ! -f "$file" ]; then
+        print_error "$file not found"
+        exit 1
+    fi
+done
+if [ -n "$baseline" ] && [ ! -f "$baseline" ]; then
+    print_error "baseline $baseline not found"
+    exit 1
+fi
+
+if [ -z "$KERNELS" ]; then
+    KERNELS=$("$QEMU" "$binary" -k list | awk 'NR > 2 { print $1 }')
+fi
+
+log=$(mktemp)
+results=$(mktemp)
+trap 'rm -f "$log" "$results"' EXIT
+
+# One single-shot run per kernel and VLEN; the plugin's total line holds
+# the counts of the kernel's own symbols
+for vlen in $VLENS; do
+    for kernel in $KERNELS; do
+        "$QEMU" -cpu "rv64,v=true,vlen=$vlen" -d plugin -D "$log" \
+            -plugin "$plugin,$MATCHES" \
+            "$binary" -s -k "$kernel" -t "$TILE" -j 1 "$SIZE" > /dev/null
+        total=$(grep '^total,' "$log" | cut -d, -f2-)
+        if [ -z "$total" ]; then
+            print_error "no instruction counts for $kernel at VLEN $vlen"
+            exit 1
+        fi
+        echo "$kernel,$vlen,$SIZE,$TILE,$total" >> "$results"
+    done
+done
+
+echo "Dynamic instruction mix, ${SIZE}x${SIZE}, tile $TILE (qemu-riscv64):"
+echo
+awk -F, '
+    BEGIN {
+        fmt = "%-12s %-6s %-12s %-9s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n"
+        printf fmt, "Method", "VLEN", "Insns", "Vector %", "VLoads", "VStores", "VFMA",
+               "Loads", "Stores", "FMA", "Branches"
+        printf fmt, "------", "----", "-----", "--------", "------", "-------", "----",
+               "-----", "------", "---", "--------"
+    }
+    {
+        printf "%-12s %-6s %-12s %-9.1f %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n",
+               $1, $2, $5, $5 ? 100.0 * $6 / $5 : 0, $8, $9, $10, $11, $12, $13, $15
+    }' "$results"
+
+if [ -n "$output" ]; then
+    { echo "$CSV_HEADER"; cat "$results"; } > "$output"
+    echo
+    echo "Counts written to $output"
+fi
+
+if [ -n "$baseline" ]; then
+    echo
+    echo "Instruction counts against $baseline (threshold +$THRESHOLD%):"
+    awk -F, -v threshold="$THRESHOLD" '
+        NR == FNR { if (FNR > 1) base[$1 "," $2 "," $3 "," $4] = $5; next }
+        {
+            key = $1 "," $2 "," $3 "," $4
+            if (!(key in base)) { printf "  %-12s VLEN %-5s %s\n", $1, $2, "not in baseline"; next }
+            change = base[key] ? 100.0 * ($5 - base[key]) / base[key] : 0
+            status = change > threshold ? "REGRESSED" : "ok"
+            if (change > threshold) regressed++
+            printf "  %-12s VLEN %-5s %12s -> %-12s %+7.2f%%  %s\n", $1, $2, base[key], $5, change, status
+        }
+        END { exit regressed ? 2 : 0 }' "$baseline" "$results" || exit 2
+fi
@@ -0,0 +1,275 @@
+// TCG plugin for qemu-riscv64 that counts the dynamic instruction mix of
+// the kernels: vector and scalar instructions, loads, stores, FMAs and
+// branches, per function symbol. Counts do not depend on the host, so they
+// serve as a hardware-free proxy for RISC-V performance.
+//
+//   qemu-riscv64 -cpu rv64,v=true,vlen=256 -d plugin -D mix.log
+//       -plugin build/insn_mix.so,match=matrix_mult_ ./matrix_mult -s -k vector 64
+//
+// Each match=SUBSTRING argument (up to MIX_MAX_MATCHES) restricts counting
+// to symbols containing it; without any, every instruction is counted. At
+// exit one CSV line per symbol and a "total" line go to the plugin log.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define MIX_MAX_MATCHES 16
+#define MIX_MAX_SYMBOLS 256
+
+enum {
+    MIX_INSNS,
+    MIX_VECTOR,         // Every V instruction, including the three below
+    MIX_VSETVL,
+    MIX_VLOAD,
+    MIX_VSTORE,
+    MIX_VFMA,
+    MIX_LOAD,           // Scalar integer and FP loads
+    MIX_STORE,
+    MIX_FMA,            // Scalar fused multiply-adds
+    MIX_FP,             // Other scalar FP arithmetic
+    MIX_BRANCH,         // Branches and jumps
+    MIX_NUM
+};
+
+static const char *mix_names[MIX_NUM] = {
+    "insns", "vector", "vsetvl", "vector_loads", "vector_stores", "vector_fma",
+    "loads", "stores", "fma", "fp", "branches"
+};
+
+typedef struct {
+    char *name;
+    uint64_t counts[MIX_NUM];
+} MixSymbol;
+
+// Mix of the counted instructions of one translated block, added to its
+// symbol every time the block executes
+typedef struct TbMix {
+    MixSymbol *symbol;
+    uint64_t counts[MIX_NUM];
+    struct TbMix *next;
+} TbMix;
+
+static const char *matches[MIX_MAX_MATCHES];
+static int num_matches;
+static MixSymbol symbols[MIX_MAX_SYMBOLS];
+static int num_symbols;
+static TbMix *blocks;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int symbol_matches(const char *name) {
+    if (num_matches == 0) return 1;
+    if (!name) return 0;
+    for (int i = 0; i < num_matches; i++) {
+        if (strstr(name, matches[i])) return 1;
+    }
+    return 0;
+}
+
+// Caller holds the lock. Symbols beyond the table share its last entry.
+static MixSymbol* find_symbol(const char *name) {
+    if (!name) name = "(unknown)";
+    for (int i = 0; i < num_symbols; i++) {
+        if (strcmp(symbols[i].name, name) == 0) return &symbols[i];
+    }
+    if (num_symbols == MIX_MAX_SYMBOLS) return &symbols[MIX_MAX_SYMBOLS - 1];
+    symbols[num_symbols].name = strdup(name);
+    return &symbols[num_symbols++];
+}
+
+// RVC: loads and stores by quadrant and funct3, plus c.j, c.beqz, c.bnez,
+// c.jr and c.jalr
+static void classify_compressed(uint32_t insn, uint64_t *counts) {
+    uint32_t quadrant = insn & 3;
+    uint32_t funct3 = (insn >> 13) & 7;
+    uint32_t rs1 = (insn >> 7) & 0x1f;
+    uint32_t rs2 = (insn >> 2) & 0x1f;
+
+    if (quadrant == 1) {
+        if (funct3 >= 5) counts[MIX_BRANCH]++;
+    } else if (funct3 >= 1 && funct3 <= 3) {
+        counts[MIX_LOAD]++;
+    } else if (funct3 >= 5) {
+        counts[MIX_STORE]++;
+    } else if (quadrant == 2 && funct3 == 4 && rs2 == 0 && rs1 != 0) {
+        counts[MIX_BRANCH]++;
+    }
+}
+
+static void classify(uint32_t insn, size_t size, uint64_t *counts) {
+    uint32_t opcode = insn & 0x7f;
+    uint32_t funct3 = (insn >> 12) & 7;
+    uint32_t funct6 = insn >> 26;
+
+    counts[MIX_INSNS]++;
+    if (size == 2) {
+        classify_compressed(insn & 0xffff, counts);
+        return;
+    }
+    switch (opcode) {
+    case 0x03:                                  // LOAD
+        counts[MIX_LOAD]++;
+        break;
+    case 0x23:                                  // STORE
+        counts[MIX_STORE]++;
+        break;
+    case 0x07:                                  // LOAD-FP
+    case 0x27:                                  // STORE-FP
+        // Widths 0, 5, 6 and 7 are vector element widths, the rest scalar FP
+        if (funct3 == 0 || funct3 >= 5) {
+            counts[MIX_VECTOR]++;
+            counts[opcode == 0x07 ? MIX_VLOAD : MIX_VSTORE]++;
+        } else {
+            counts[opcode == 0x07 ? MIX_LOAD : MIX_STORE]++;
+        }
+        break;
+    case 0x43:                                  // FMADD, FMSUB, FNMSUB, FNMADD
+    case 0x47:
+    case 0x4b:
+    case 0x4f:
+        counts[MIX_FMA]++;
+        break;
+    case 0x53:                                  // OP-FP
+        counts[MIX_FP]++;
+        break;
+    case 0x57:                                  // OP-V
+        counts[MIX_VECTOR]++;
+        if (funct3 == 7) {
+            counts[MIX_VSETVL]++;
+        } else if ((funct3 == 1 || funct3 == 5) &&
+                   ((funct6 & 0x38) == 0x28 || (funct6 & 0x3c) == 0x3c)) {
+            // OPFVV/OPFVF 101xxx: vfmadd to vfnmsac; 1111xx: widening vfwmacc
+            counts[MIX_VFMA]++;
+        }
+        break;
+    case 0x63:                                  // BRANCH, JALR, JAL
+    case 0x67:
+    case 0x6f:
+        counts[MIX_BRANCH]++;
+        break;
+    }
+}
+
+static uint32_t insn_bits(const struct qemu_plugin_insn *insn, size_t size) {
+    uint8_t bytes[4] = {0};
+
+    if (size > sizeof(bytes)) size = sizeof(bytes);
+#if QEMU_PLUGIN_VERSION >= 2
+    qemu_plugin_insn_data(insn, bytes, size);
+#else
+    memcpy(bytes, qemu_plugin_insn_data(insn), size);
+#endif
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+           (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static void tb_exec(unsigned int vcpu_index, void *udata) {
+    TbMix *mix = udata;
+    (void)vcpu_index;
+
+    for (int i = 0; i < MIX_NUM; i++) {
+        if (mix->counts[i]) __atomic_fetch_add(&mix->symbol->counts[i], mix->counts[i], __ATOMIC_RELAXED);
+    }
+}
+
+// A block never spans two functions, so its first counted instruction
+// names the symbol
+static void tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb) {
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    TbMix *mix = NULL;
+    (void)id;
+
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        const char *name = qemu_plugin_insn_symbol(insn);
+        size_t size = qemu_plugin_insn_size(insn);
+
+        if (!symbol_matches(name)) continue;
+        if (!mix) {
+            mix = calloc(1, sizeof(TbMix));
+            if (!mix) return;
+            pthread_mutex_lock(&lock);
+            mix->symbol = find_symbol(name);
+            mix->next = blocks;
+            blocks = mix;
+            pthread_mutex_unlock(&lock);
+        }
+        classify(insn_bits(insn, size), size, mix->counts);
+    }
+    if (mix) qemu_plugin_register_vcpu_tb_exec_cb(tb, tb_exec, QEMU_PLUGIN_CB_NO_REGS, mix);
+}
+
+static int compare_insns(const void *a, const void *b) {
+    uint64_t x = (*(MixSymbol * const *)a)->counts[MIX_INSNS];
+    uint64_t y = (*(MixSymbol * const *)b)->counts[MIX_INSNS];
+    return (x < y) - (x > y);
+}
+
+static void print_row(const char *name, const uint64_t *counts) {
+    char line[512];
+    int len = snprintf(line, sizeof(line), "%s", name);
+
+    for (int i = 0; i < MIX_NUM && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, ",%llu", (unsigned long long)counts[i]);
+    }
+    if (len < (int)sizeof(line) - 1) {
+        line[len] = '\n';
+        line[len + 1] = '\0';
+    }
+    qemu_plugin_outs(line);
+}
+
+// Largest symbols first, then their sum
+static void plugin_exit(qemu_plugin_id_t id, void *p) {
+    uint64_t total[MIX_NUM] = {0};
+    char header[256];
+    int len = snprintf(header, sizeof(header), "symbol");
+    (void)id;
+    (void)p;
+
+    for (int i = 0; i < MIX_NUM; i++) {
+        len += snprintf(header + len, sizeof(header) - len, ",%s", mix_names[i]);
+    }
+    snprintf(header + len, sizeof(header) - len, "\n");
+    qemu_plugin_outs(header);
+
+    MixSymbol *order[MIX_MAX_SYMBOLS];
+    for (int s = 0; s < num_symbols; s++) order[s] = &symbols[s];
+    qsort(order, num_symbols, sizeof(MixSymbol *), compare_insns);
+    for (int s = 0; s < num_symbols; s++) {
+        if (order[s]->counts[MIX_INSNS] == 0) continue;
+        print_row(order[s]->name, order[s]->counts);
+        for (int i = 0; i < MIX_NUM; i++) total[i] += order[s]->counts[i];
+    }
+    print_row("total", total);
+
+    while (blocks) {
+        TbMix *next = blocks->next;
+        free(blocks);
+        blocks = next;
+    }
+    for (int s = 0; s < num_symbols; s++) free(symbols[s].name);
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv) {
+    if (strcmp(info->target_name, "riscv64") != 0 && strcmp(info->target_name, "riscv32") != 0) {
+        fprintf(stderr, "insn_mix: decodes RISC-V only, not %s\n", info->target_name);
+        return -1;
+    }
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "match=", 6) == 0 && num_matches < MIX_MAX_MATCHES) {
+            matches[num_matches++] = argv[i] + 6;
+        } else {
+            fprintf(stderr, "insn_mix: unknown or excess argument '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+    qemu_plugin_register_vcpu_tb_trans_cb(id, tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
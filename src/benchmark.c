@@ -0,0 +1,332 @@
+#include "benchmark.h"
+#include "config.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Configuration
+void bench_config_default(BenchConfig *cfg) {
+    cfg->warmup_iterations = WARMUP_ITERATIONS;
+    cfg->min_iterations = BENCHMARK_ITERATIONS;
+    cfg->max_iterations = BENCHMARK_MAX_ITERATIONS;
+    cfg->target_rel_ci = BENCHMARK_TARGET_REL_CI;
+    cfg->time_budget_seconds = BENCHMARK_TIME_BUDGET;
+    cfg->single_shot = 0;
+    cfg->prepare = NULL;
+    cfg->prepare_user = NULL;
+    cfg->num_hooks = 0;
+}
+
+int bench_add_hook(BenchConfig *cfg, const BenchHook *hook) {
+    if (cfg->num_hooks >= BENCH_MAX_HOOKS) return -1;
+    cfg->hooks[cfg->num_hooks++] = hook;
+    return 0;
+}
+
+// Time one sample, running the hooks around (but outside) the timed region
+static double bench_sample(const BenchConfig *cfg, bench_fn fn, void *ctx, size_t iteration) {
+    Timer timer;
+
+    if (cfg->prepare) cfg->prepare(cfg->prepare_user);
+    for (int h = 0; h < cfg->num_hooks; h++) {
+        if (cfg->hooks[h]->before_sample) cfg->hooks[h]->before_sample(cfg->hooks[h]->user);
+    }
+
+    timer_start(&timer);
+    fn(ctx);
+    timer_stop(&timer);
+    double seconds = timer_elapsed_seconds(&timer);
+
+    // Reverse order so hooks nest like brackets around the kernel
+    for (int h = cfg->num_hooks - 1; h >= 0; h--) {
+        if (cfg->hooks[h]->after_sample) cfg->hooks[h]->after_sample(cfg->hooks[h]->user, iteration, seconds);
+    }
+    return seconds;
+}
+
+static int bench_append_sample(BenchResult *result, double seconds) {
+    if (result->count == result->capacity) {
+        size_t new_capacity = result->capacity ? result->capacity * 2 : 16;
+        double *samples = realloc(result->samples, new_capacity * sizeof(double));
+        if (!samples) return -1;
+        result->samples = samples;
+        result->capacity = new_capacity;
+    }
+    result->samples[result->count++] = seconds;
+    return 0;
+}
+
+// Benchmark driver
+//
+// The first call is timed on its own: it pays for page faults on untouched
+// output and cold caches, which a long-running caller sees only once. It
+// counts as the first warmup. The remaining warmups absorb frequency
+// ramp-up. Timed iterations then continue until the 95% confidence interval
+// of the mean is tight enough, the time budget is spent, or max_iterations
+// is reached. A kernel that alone exceeds the budget still gets one timed
+// sample.
+int bench_run(const BenchConfig *cfg, bench_fn fn, void *ctx, BenchResult *result) {
+    Timer total;
+
+    memset(result, 0, sizeof(*result));
+    timer_start(&total);
+
+    if (cfg->single_shot) {
+        if (bench_append_sample(result, bench_sample(cfg, fn, ctx, 0)) != 0) return -1;
+        result->first_call_seconds = result->samples[0];
+    } else {
+        Timer first;
+        timer_start(&first);
+        fn(ctx);
+        timer_stop(&first);
+        result->first_call_seconds = timer_elapsed_seconds(&first);
+        result->warmups_run = 1;
+
+        for (int w = 1; w < cfg->warmup_iterations; w++) {
+            if (cfg->prepare) cfg->prepare(cfg->prepare_user);
+            fn(ctx);
+            result->warmups_run++;
+            timer_stop(&total);
+            if (timer_elapsed_seconds(&total) >= cfg->time_budget_seconds) break;
+        }
+
+        // The budget covers sampling only, so restart it after the warmups
+        Timer budget;
+        timer_start(&budget);
+        int max_iterations = cfg->max_iterations > 0 ? cfg->max_iterations : 1;
+
+        while (result->count < (size_t)max_iterations) {
+            double seconds = bench_sample(cfg, fn, ctx, result->count);
+            if (bench_append_sample(result, seconds) != 0) return -1;
+
+            timer_stop(&budget);
+            if (timer_elapsed_seconds(&budget) >= cfg->time_budget_seconds) break;
+
+            if (result->count >= (size_t)cfg->min_iterations && result->count >= 2) {
+                bench_stats_compute(result->samples, result->count, &result->stats);
+                if (result->stats.rel_ci95 <= cfg->target_rel_ci) break;
+            }
+        }
+    }
+
+    timer_stop(&total);
+    result->total_seconds = timer_elapsed_seconds(&total);
+    bench_stats_compute(result->samples, result->count, &result->stats);
+    return 0;
+}
+
+// 95% confidence half-width of the geometric mean of the per-pair ratios
+// a / b, relative to it. A Student t interval on the log ratios stands in
+// for the bootstrap that reports the speedup, which is too slow per sample.
+static double bench_paired_rel_ci95(const BenchResult *a, const BenchResult *b) {
+    size_t count = a->count;
+    double sum = 0.0, sq = 0.0;
+
+    if (count < 2) return INFINITY;
+    for (size_t i = 0; i < count; i++) {
+        if (a->samples[i] <= 0.0 || b->samples[i] <= 0.0) return INFINITY;
+        sum += log(a->samples[i] / b->samples[i]);
+    }
+    double mean = sum / (double)count;
+    for (size_t i = 0; i < count; i++) {
+        double d = log(a->samples[i] / b->samples[i]) - mean;
+        sq += d * d;
+    }
+    double half = bench_t_critical95(count - 1) * sqrt(sq / (double)(count - 1) / (double)count);
+    return exp(half) - 1.0;
+}
+
+// Paired runs of two kernels on the same inputs. Warmups and samples
+// alternate between a and b, and the order within each pair flips every
+// pair, so drift in clock speed or temperature lands on both kernels
+// evenly. Sample i of a and sample i of b form pair i. Sampling stops once
+// the ratio between them is known to the target CI; the kernels' own
+// spreads matter less, since drift moves both. The time budget covers
+// both kernels, so it is doubled, for the warmups as for the samples.
+int bench_run_paired(const BenchConfig *cfg, bench_fn fn_a, void *ctx_a,
+                     bench_fn fn_b, void *ctx_b, BenchResult *result_a, BenchResult *result_b) {
+    Timer first, total, budget;
+    int max_iterations = cfg->max_iterations > 0 ? cfg->max_iterations : 1;
+
+    memset(result_a, 0, sizeof(*result_a));
+    memset(result_b, 0, sizeof(*result_b));
+    timer_start(&total);
+
+    // Single shot: one pair, no warmups
+    if (cfg->single_shot) {
+        if (bench_append_sample(result_a, bench_sample(cfg, fn_a, ctx_a, 0)) != 0) return -1;
+        if (bench_append_sample(result_b, bench_sample(cfg, fn_b, ctx_b, 0)) != 0) return -1;
+        result_a->first_call_seconds = result_a->samples[0];
+        result_b->first_call_seconds = result_b->samples[0];
+        max_iterations = 1;
+    } else {
+        timer_start(&first);
+        fn_a(ctx_a);
+        timer_stop(&first);
+        result_a->first_call_seconds = timer_elapsed_seconds(&first);
+        timer_start(&first);
+        fn_b(ctx_b);
+        timer_stop(&first);
+        result_b->first_call_seconds = timer_elapsed_seconds(&first);
+        result_a->warmups_run = result_b->warmups_run = 1;
+
+        for (int w = 1; w < cfg->warmup_iterations; w++) {
+            if (cfg->prepare) cfg->prepare(cfg->prepare_user);
+            fn_a(ctx_a);
+            if (cfg->prepare) cfg->prepare(cfg->prepare_user);
+            fn_b(ctx_b);
+            result_a->warmups_run++;
+            result_b->warmups_run++;
+            timer_stop(&total);
+            if (timer_elapsed_seconds(&total) >= 2.0 * cfg->time_budget_seconds) break;
+        }
+    }
+
+    timer_start(&budget);
+    while (result_a->count < (size_t)max_iterations) {
+        size_t i = result_a->count;
+        double seconds_a, seconds_b;
+
+        if (i % 2 == 0) {
+            seconds_a = bench_sample(cfg, fn_a, ctx_a, i);
+            seconds_b = bench_sample(cfg, fn_b, ctx_b, i);
+        } else {
+            seconds_b = bench_sample(cfg, fn_b, ctx_b, i);
+            seconds_a = bench_sample(cfg, fn_a, ctx_a, i);
+        }
+        if (bench_append_sample(result_a, seconds_a) != 0) return -1;
+        if (bench_append_sample(result_b, seconds_b) != 0) return -1;
+
+        timer_stop(&budget);
+        if (timer_elapsed_seconds(&budget) >= 2.0 * cfg->time_budget_seconds) break;
+
+        if (result_a->count >= (size_t)cfg->min_iterations &&
+            bench_paired_rel_ci95(result_a, result_b) <= cfg->target_rel_ci) {
+            break;
+        }
+    }
+
+    timer_stop(&total);
+    result_a->total_seconds = result_b->total_seconds = timer_elapsed_seconds(&total);
+    bench_stats_compute(result_a->samples, result_a->count, &result_a->stats);
+    bench_stats_compute(result_b->samples, result_b->count, &result_b->stats);
+    return 0;
+}
+
+void bench_result_free(BenchResult *result) {
+    if (!result) return;
+    free(result->samples);
+    result->samples = NULL;
+    result->count = 0;
+    result->capacity = 0;
+}
+
+// Statistics
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between closest ranks; p in [0, 1]
+double bench_percentile(const double *sorted, size_t count, double p) {
+    if (count == 0) return 0.0;
+    if (count == 1) return sorted[0];
+
+    double rank = p * (double)(count - 1);
+    size_t lo = (size_t)rank;
+    size_t hi = lo + 1 < count ? lo + 1 : lo;
+    double frac = rank - (double)lo;
+    return sorted[lo] + frac * (sorted[hi] - sorted[lo]);
+}
+
+// Two-sided 95% Student t critical values
+double bench_t_critical95(size_t dof) {
+    static const double table[] = {
+        0.0,    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+        2.228,  2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+        2.086,  2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+        2.042
+    };
+
+    if (dof == 0) return INFINITY;
+    if (dof < sizeof(table) / sizeof(table[0])) return table[dof];
+    if (dof < 60) return 2.000;
+    if (dof < 120) return 1.980;
+    return 1.960;
+}
+
+void bench_stats_compute(const double *samples, size_t count, BenchStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->count = count;
+    if (count == 0) return;
+
+    double *sorted = malloc(count * sizeof(double));
+    if (!sorted) return;
+    memcpy(sorted, samples, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += sorted[i];
+    }
+    double mean = sum / (double)count;
+
+    double sq = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double d = sorted[i] - mean;
+        sq += d * d;
+    }
+    double stddev = count > 1 ? sqrt(sq / (double)(count - 1)) : 0.0;
+
+    stats->min = sorted[0];
+    stats->max = sorted[count - 1];
+    stats->mean = mean;
+    stats->median = bench_percentile(sorted, count, 0.5);
+    stats->p90 = bench_percentile(sorted, count, 0.9);
+    stats->stddev = stddev;
+    stats->cv = mean > 0.0 ? stddev / mean : 0.0;
+    stats->rel_ci95 = (count > 1 && mean > 0.0)
+        ? bench_t_critical95(count - 1) * stddev / sqrt((double)count) / mean
+        : INFINITY;
+
+    free(sorted);
+}
+
+// Reporting
+void print_benchmark_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-10s %-10s %-10s %-10s %-9s %-7s %-5s %-8s\n",
+            "Method", "Size", "Min (ms)", "Med (ms)", "Mean (ms)", "P90 (ms)",
+           "Std (ms)", "CV (%)", "N", "GFLOPS");
+    fprintf(out, "%-12s %-6s %-10s %-10s %-10s %-10s %-9s %-7s %-5s %-8s\n",
+            "------", "----", "--------", "--------", "---------", "--------",
+            "--------", "------", "-", "------");
+}
+
+void print_benchmark_result(FILE *out, const char *method, size_t matrix_size,
+                            const BenchResult *result) {
+    const BenchStats *s = &result->stats;
+    fprintf(out, "%-12s %-6zu %-10.3f %-10.3f %-10.3f %-10.3f %-9.3f %-7.2f %-5zu %-8.2f\n",
+            method, matrix_size,
+            s->min * 1000.0, s->median * 1000.0, s->mean * 1000.0, s->p90 * 1000.0,
+            s->stddev * 1000.0, s->cv * 100.0, s->count,
+            calculate_gflops(matrix_size, s->median));
+}
+
+void print_first_call_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-12s %-10s %-8s\n", "Method", "Size", "First (ms)", "Med (ms)", "Ratio");
+    fprintf(out, "%-12s %-6s %-12s %-10s %-8s\n", "------", "----", "----------", "--------", "-----");
+}
+
+// Ratio of the first call to the steady-state median
+void print_first_call_result(FILE *out, const char *method, size_t matrix_size,
+                             const BenchResult *result) {
+    double median = result->stats.median;
+    fprintf(out, "%-12s %-6zu %-12.3f %-10.3f %-8.2f\n",
+            method, matrix_size, result->first_call_seconds * 1000.0, median * 1000.0,
+            median > 0.0 ? result->first_call_seconds / median : 0.0);
+}
@@ -0,0 +1,178 @@
+#include "cache_control.h"
+#include "config.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__riscv) && defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CACHE_FLUSH_MIN_BYTES ((size_t)8 * 1024 * 1024)
+#define CACHE_FLUSH_MAX_BYTES ((size_t)512 * 1024 * 1024)
+
+// Keeps the compiler from dropping the loads
+static volatile unsigned char cache_sink;
+
+int cache_parse_mode(const char *text, CacheMode *mode) {
+    if (strcmp(text, "warm") == 0) {
+        *mode = CACHE_WARM;
+    } else if (strcmp(text, "cold") == 0) {
+        *mode = CACHE_COLD;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char* cache_mode_name(CacheMode mode) {
+    return mode == CACHE_COLD ? "cold" : "warm";
+}
+
+// Twice the LLC so that no line survives an LRU-ish replacement policy
+int cache_flusher_init(CacheFlusher *cf, size_t bytes) {
+    if (bytes == 0) bytes = 2 * get_cache_size(3);
+    if (bytes < CACHE_FLUSH_MIN_BYTES) bytes = CACHE_FLUSH_MIN_BYTES;
+    if (bytes > CACHE_FLUSH_MAX_BYTES) bytes = CACHE_FLUSH_MAX_BYTES;
+
+    cf->buffer = prefaulted_malloc(bytes);
+    cf->bytes = cf->buffer ? bytes : 0;
+    return cf->buffer ? 0 : -1;
+}
+
+void cache_flusher_free(CacheFlusher *cf) {
+    prefaulted_free(cf->buffer, cf->bytes);
+    cf->buffer = NULL;
+    cf->bytes = 0;
+}
+
+// Writes as well as reads, so dirty operand lines are evicted too and the
+// next call does not find them in a write-back buffer
+void cache_flush(CacheFlusher *cf) {
+    cache_touch(cf->buffer, cf->bytes, 1);
+}
+
+// Volatile accesses so the unchanged write-back is not optimized away
+void cache_touch(void *data, size_t bytes, int write) {
+    volatile unsigned char *p = data;
+    unsigned char acc = 0;
+
+    if (!p) return;
+    for (size_t off = 0; off < bytes; off += CACHE_LINE_SIZE) {
+        unsigned char v = p[off];
+        acc ^= v;
+        if (write) p[off] = v;
+    }
+    cache_sink = acc;
+}
+
+#if defined(__riscv) && defined(__linux__)
+
+// riscv_hwprobe (Linux 6.4), spelled out so older headers still build
+#define CACHE_HWPROBE_SYSCALL           258
+#define CACHE_HWPROBE_IMA_EXT_0         4
+#define CACHE_HWPROBE_EXT_ZICBOZ        (1ULL << 6)
+#define CACHE_HWPROBE_ZICBOZ_BLOCK_SIZE 6
+
+typedef struct {
+    int64_t key;
+    uint64_t value;
+} CacheHwprobePair;
+
+// cbo.zero block size, 0 without Zicboz
+static size_t cache_zero_block;
+
+__attribute__((constructor)) static void cache_zero_detect(void) {
+    CacheHwprobePair pairs[2] = {
+        { CACHE_HWPROBE_IMA_EXT_0, 0 },
+        { CACHE_HWPROBE_ZICBOZ_BLOCK_SIZE, 0 }
+    };
+
+    if (syscall(CACHE_HWPROBE_SYSCALL, pairs, 2, 0, NULL, 0) != 0) return;
+    if (!(pairs[0].value & CACHE_HWPROBE_EXT_ZICBOZ)) return;
+    // A power of two, as the spec requires, or Zicboz goes unused
+    if (pairs[1].key == CACHE_HWPROBE_ZICBOZ_BLOCK_SIZE && pairs[1].value >= 16 &&
+        (pairs[1].value & (pairs[1].value - 1)) == 0) {
+        cache_zero_block = (size_t)pairs[1].value;
+    }
+}
+
+// Whole aligned blocks with cbo.zero (encoded so no -march=..._zicboz is
+// needed), the unaligned ends with memset
+void cache_zero(void *data, size_t bytes) {
+    unsigned char *p = data;
+    unsigned char *end = p + bytes;
+    size_t block = cache_zero_block;
+
+    if (!p) return;
+    if (block == 0 || bytes < 2 * block) {
+        memset(p, 0, bytes);
+        return;
+    }
+    unsigned char *first = (unsigned char *)(((uintptr_t)p + block - 1) & ~(uintptr_t)(block - 1));
+    memset(p, 0, (size_t)(first - p));
+    for (; first + block <= end; first += block) {
+        __asm__ volatile(".insn i 0x0f, 2, x0, %0, 4" : : "r"(first) : "memory");
+    }
+    memset(first, 0, (size_t)(end - first));
+}
+
+const char* cache_zero_method(void) {
+    static char method[48];
+
+    if (cache_zero_block == 0) return "memset (no Zicboz)";
+    snprintf(method, sizeof(method), "cbo.zero, %zu-byte blocks", cache_zero_block);
+    return method;
+}
+
+#elif defined(__SSE2__)
+
+// Streaming only pays once C could not stay cached anyway
+static size_t cache_zero_stream_bytes;
+
+__attribute__((constructor)) static void cache_zero_detect(void) {
+    cache_zero_stream_bytes = get_cache_size(3);
+}
+
+// 16-byte non-temporal stores skip the read for ownership of every line
+void cache_zero(void *data, size_t bytes) {
+    unsigned char *p = data;
+    unsigned char *end = p + bytes;
+
+    if (!p) return;
+    if (bytes < cache_zero_stream_bytes) {
+        memset(p, 0, bytes);
+        return;
+    }
+    unsigned char *first = (unsigned char *)(((uintptr_t)p + 15) & ~(uintptr_t)15);
+    memset(p, 0, (size_t)(first - p));
+    for (; first + 16 <= end; first += 16) {
+        _mm_stream_si128((__m128i *)first, _mm_setzero_si128());
+    }
+    _mm_sfence();
+    memset(first, 0, (size_t)(end - first));
+}
+
+const char* cache_zero_method(void) {
+    static char method[64];
+
+    snprintf(method, sizeof(method), "non-temporal stores from %.1f MB",
+             (double)cache_zero_stream_bytes / (1024.0 * 1024.0));
+    return method;
+}
+
+#else
+
+void cache_zero(void *data, size_t bytes) {
+    if (data) memset(data, 0, bytes);
+}
+
+const char* cache_zero_method(void) {
+    return "memset";
+}
+
+#endif
@@ -0,0 +1,350 @@
+#include "compare.h"
+#include "config.h"
+#include "benchmark.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CSV_MAX_LINE 4096
+#define CSV_MAX_FIELDS 64
+
+// Split one CSV line in place; handles quoted fields with doubled quotes
+static int csv_split(char *line, char **fields, int max_fields) {
+    int count = 0;
+    char *p = line;
+
+    line[strcspn(line, "\r\n")] = '\0';
+    while (count < max_fields) {
+        if (*p == '"') {
+            char *dst = ++p;
+            fields[count++] = dst;
+            while (*p) {
+                if (*p == '"' && p[1] == '"') {
+                    *dst++ = '"';
+                    p += 2;
+                } else if (*p == '"') {
+                    p++;
+                    break;
+                } else {
+                    *dst++ = *p++;
+                }
+            }
+            *dst = '\0';
+            if (*p == ',') p++;
+            else break;
+        } else {
+            fields[count++] = p;
+            char *comma = strchr(p, ',');
+            if (!comma) break;
+            *comma = '\0';
+            p = comma + 1;
+        }
+    }
+    return count;
+}
+
+static int csv_column(char **header, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(header[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+static BaselineEntry* baseline_find_or_add(Baseline *baseline, const char *kernel,
+                                           size_t size, size_t tile, int threads) {
+    for (size_t i = 0; i < baseline->count; i++) {
+        BaselineEntry *e = &baseline->entries[i];
+        if (e->size == size && e->tile == tile && e->threads == threads &&
+            strcmp(e->kernel, kernel) == 0) {
+            return e;
+        }
+    }
+
+    if (baseline->count == baseline->capacity) {
+        size_t new_capacity = baseline->capacity ? baseline->capacity * 2 : 8;
+        BaselineEntry *entries = realloc(baseline->entries, new_capacity * sizeof(BaselineEntry));
+        if (!entries) return NULL;
+        baseline->entries = entries;
+        baseline->capacity = new_capacity;
+    }
+
+    BaselineEntry *e = &baseline->entries[baseline->count++];
+    memset(e, 0, sizeof(*e));
+    snprintf(e->kernel, sizeof(e->kernel), "%s", kernel);
+    e->size = size;
+    e->tile = tile;
+    e->threads = threads;
+    return e;
+}
+
+int baseline_load(const char *path, Baseline *baseline) {
+    char header_line[CSV_MAX_LINE];
+    char line[CSV_MAX_LINE];
+    char *header[CSV_MAX_FIELDS];
+    char *fields[CSV_MAX_FIELDS];
+
+    memset(baseline, 0, sizeof(*baseline));
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: Cannot open baseline file '%s'\n", path);
+        return -1;
+    }
+
+    if (!fgets(header_line, sizeof(header_line), f)) {
+        fprintf(stderr, "Error: Baseline file '%s' is empty\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    // Columns are looked up by name so newer files with extra columns still load
+    int header_count = csv_split(header_line, header, CSV_MAX_FIELDS);
+    int col_kernel = csv_column(header, header_count, "kernel");
+    int col_size = csv_column(header, header_count, "size");
+    int col_tile = csv_column(header, header_count, "tile");
+    int col_threads = csv_column(header, header_count, "threads");
+    int col_time = csv_column(header, header_count, "time_ms");
+
+    if (col_kernel < 0 || col_size < 0 || col_tile < 0 || col_threads < 0 || col_time < 0) {
+        fprintf(stderr, "Error: '%s' is not a --format=csv results file\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        int count = csv_split(line, fields, CSV_MAX_FIELDS);
+        if (count < header_count) continue;
+
+        BaselineEntry *e = baseline_find_or_add(baseline, fields[col_kernel],
+                                                (size_t)strtoull(fields[col_size], NULL, 10),
+                                                (size_t)strtoull(fields[col_tile], NULL, 10),
+                                                atoi(fields[col_threads]));
+        if (!e) goto oom;
+
+        if (e->count == e->capacity) {
+            size_t new_capacity = e->capacity ? e->capacity * 2 : 16;
+            double *samples = realloc(e->samples, new_capacity * sizeof(double));
+            if (!samples) goto oom;
+            e->samples = samples;
+            e->capacity = new_capacity;
+        }
+        e->samples[e->count++] = atof(fields[col_time]) / 1000.0;
+    }
+
+    fclose(f);
+    if (baseline->count == 0) {
+        fprintf(stderr, "Error: Baseline file '%s' has no records\n", path);
+        return -1;
+    }
+    return 0;
+
+oom:
+    fprintf(stderr, "Error: Out of memory loading baseline\n");
+    fclose(f);
+    baseline_free(baseline);
+    return -1;
+}
+
+void baseline_free(Baseline *baseline) {
+    if (!baseline) return;
+    for (size_t i = 0; i < baseline->count; i++) {
+        free(baseline->entries[i].samples);
+    }
+    free(baseline->entries);
+    memset(baseline, 0, sizeof(*baseline));
+}
+
+// Mann-Whitney U test
+typedef struct {
+    double value;
+    int group;
+} RankedSample;
+
+static int compare_ranked(const void *a, const void *b) {
+    double x = ((const RankedSample *)a)->value;
+    double y = ((const RankedSample *)b)->value;
+    return (x > y) - (x < y);
+}
+
+double mann_whitney_p_greater(const double *a, size_t na, const double *b, size_t nb) {
+    size_t n = na + nb;
+    if (na == 0 || nb == 0) return 1.0;
+
+    RankedSample *all = malloc(n * sizeof(RankedSample));
+    if (!all) return 1.0;
+    for (size_t i = 0; i < na; i++) {
+        all[i].value = a[i];
+        all[i].group = 0;
+    }
+    for (size_t i = 0; i < nb; i++) {
+        all[na + i].value = b[i];
+        all[na + i].group = 1;
+    }
+    qsort(all, n, sizeof(RankedSample), compare_ranked);
+
+    // Average ranks over ties and accumulate the tie correction term
+    double rank_sum_a = 0.0;
+    double tie_term = 0.0;
+    size_t i = 0;
+    while (i < n) {
+        size_t j = i;
+        while (j + 1 < n && all[j + 1].value == all[i].value) j++;
+        double avg_rank = (double)(i + j) / 2.0 + 1.0;
+        double t = (double)(j - i + 1);
+        tie_term += t * t * t - t;
+        for (size_t k = i; k <= j; k++) {
+            if (all[k].group == 0) rank_sum_a += avg_rank;
+        }
+        i = j + 1;
+    }
+    free(all);
+
+    double u = rank_sum_a - (double)na * (double)(na + 1) / 2.0;
+    double mean_u = (double)na * (double)nb / 2.0;
+    double var_u = (double)na * (double)nb / 12.0 *
+                   ((double)(n + 1) - tie_term / ((double)n * (double)(n - 1)));
+    if (var_u <= 0.0) return 1.0;
+
+    // Continuity-corrected upper tail
+    double z = (u - mean_u - 0.5) / sqrt(var_u);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+// Regression gate
+void compare_config_default(CompareConfig *cfg) {
+    cfg->alpha = COMPARE_DEFAULT_ALPHA;
+    cfg->threshold = COMPARE_DEFAULT_THRESHOLD;
+}
+
+static double median_of(const double *samples, size_t count) {
+    BenchStats stats;
+    bench_stats_compute(samples, count, &stats);
+    return stats.median;
+}
+
+// A change is flagged only when it is both statistically significant and
+// larger than the threshold, so tiny but consistent shifts do not fail runs
+void compare_samples(const CompareConfig *cfg,
+                     const double *current, size_t current_count,
+                     const double *baseline, size_t baseline_count,
+                     CompareResult *result) {
+    double base_median = median_of(baseline, baseline_count);
+    double cur_median = median_of(current, current_count);
+
+    result->ratio = base_median > 0.0 ? cur_median / base_median : 1.0;
+    result->p_slower = mann_whitney_p_greater(current, current_count, baseline, baseline_count);
+    result->p_faster = mann_whitney_p_greater(baseline, baseline_count, current, current_count);
+
+    if (current_count < COMPARE_MIN_SAMPLES || baseline_count < COMPARE_MIN_SAMPLES) {
+        result->verdict = COMPARE_INCONCLUSIVE;
+    } else if (result->p_slower < cfg->alpha && result->ratio > 1.0 + cfg->threshold) {
+        result->verdict = COMPARE_REGRESSED;
+    } else if (result->p_faster < cfg->alpha && result->ratio < 1.0 - cfg->threshold) {
+        result->verdict = COMPARE_IMPROVED;
+    } else {
+        result->verdict = COMPARE_UNCHANGED;
+    }
+}
+
+// Paired A/B comparison
+static int compare_ascending(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// splitmix64; a fixed seed keeps intervals reproducible between runs
+static uint64_t bootstrap_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Works on log ratios, so the interval of a 2x speedup is as wide as that
+// of a 2x slowdown
+int compare_paired_bootstrap(const double *a, const double *b, size_t count,
+                             size_t resamples, PairedResult *result) {
+    uint64_t state = 42;
+    double sum = 0.0;
+
+    if (count < 2 || resamples < 2) return -1;
+    for (size_t i = 0; i < count; i++) {
+        if (!(a[i] > 0.0) || !(b[i] > 0.0)) return -1;     // No log ratio, NaN included
+    }
+    double *logs = malloc(count * sizeof(double));
+    double *means = malloc(resamples * sizeof(double));
+    if (!logs || !means) {
+        free(logs);
+        free(means);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        logs[i] = log(a[i] / b[i]);
+        sum += logs[i];
+    }
+    for (size_t r = 0; r < resamples; r++) {
+        double resampled = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            resampled += logs[bootstrap_next(&state) % count];
+        }
+        means[r] = resampled / (double)count;
+    }
+    qsort(means, resamples, sizeof(double), compare_ascending);
+
+    result->speedup = exp(sum / (double)count);
+    result->ci_low = exp(bench_percentile(means, resamples, 0.025));
+    result->ci_high = exp(bench_percentile(means, resamples, 0.975));
+    result->pairs = count;
+    free(logs);
+    free(means);
+    return 0;
+}
+
+const char* compare_verdict_name(CompareVerdict verdict) {
+    switch (verdict) {
+        case COMPARE_IMPROVED: return "improved";
+        case COMPARE_REGRESSED: return "REGRESSED";
+        case COMPARE_INCONCLUSIVE: return "inconclusive";
+        default: return "unchanged";
+    }
+}
+
+// Reporting
+void print_compare_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-5s %-8s %-12s %-12s %-8s %-10s %-12s\n",
+            "Method", "Size", "Tile", "Threads", "Base (ms)", "Now (ms)",
+            "Change", "p-value", "Verdict");
+    fprintf(out, "%-12s %-6s %-5s %-8s %-12s %-12s %-8s %-10s %-12s\n",
+            "------", "----", "----", "-------", "---------", "--------",
+            "------", "-------", "-------");
+}
+
+void print_compare_result(FILE *out, const BaselineEntry *entry,
+                          double current_median, const CompareResult *result) {
+    double p = result->ratio >= 1.0 ? result->p_slower : result->p_faster;
+    char change[16];
+    snprintf(change, sizeof(change), "%+.1f%%", (result->ratio - 1.0) * 100.0);
+    fprintf(out, "%-12s %-6zu %-5zu %-8d %-12.3f %-12.3f %-8s %-10.4f %-12s\n",
+            entry->kernel, entry->size, entry->tile, entry->threads,
+            median_of(entry->samples, entry->count) * 1000.0, current_median * 1000.0,
+            change, p, compare_verdict_name(result->verdict));
+}
+
+// An interval that excludes 1 is a significant difference at the 5% level
+void print_paired_result(FILE *out, const char *name_a, const char *name_b,
+                         const PairedResult *result) {
+    fprintf(out, "\n%s vs %s over %zu interleaved pairs:\n", name_b, name_a, result->pairs);
+    fprintf(out, "  Speedup of %s: %.3fx (95%% CI %.3fx - %.3fx)\n",
+            name_b, result->speedup, result->ci_low, result->ci_high);
+    if (result->ci_low > 1.0) {
+        fprintf(out, "  %s is faster than %s\n", name_b, name_a);
+    } else if (result->ci_high < 1.0) {
+        fprintf(out, "  %s is slower than %s\n", name_b, name_a);
+    } else {
+        fprintf(out, "  No significant difference\n");
+    }
+}
@@ -0,0 +1,245 @@
+#include "energy.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <glob.h>
+#endif
+
+// Read the first line of a sysfs file, without the newline
+static int read_line(const char *path, char *buf, size_t len) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    if (!fgets(buf, (int)len, f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static int read_number(const char *path, double *value) {
+    char buf[64];
+    char *end;
+
+    if (read_line(path, buf, sizeof(buf)) != 0) return -1;
+    *value = strtod(buf, &end);
+    return end == buf ? -1 : 0;
+}
+
+#ifdef __linux__
+
+// Replace the last path component of path with name
+static void sibling_path(char *out, size_t len, const char *path, const char *name) {
+    const char *slash = strrchr(path, '/');
+    int dir_len = slash ? (int)(slash - path) : 0;
+    snprintf(out, len, "%.*s/%s", dir_len, path, name);
+}
+
+static int add_source(EnergyMeter *em, const char *path, const char *label,
+                      EnergySourceKind kind, double max_range_uj) {
+    double value;
+
+    if (em->count >= ENERGY_MAX_SOURCES) return -1;
+    if (read_number(path, &value) != 0) {
+        // RAPL counters are root-only on most distributions
+        snprintf(em->error, sizeof(em->error), "%s not readable", path);
+        return -1;
+    }
+
+    EnergySource *src = &em->sources[em->count++];
+    snprintf(src->path, sizeof(src->path), "%s", path);
+    snprintf(src->label, sizeof(src->label), "%s", label);
+    src->kind = kind;
+    src->max_range_uj = max_range_uj;
+    return 0;
+}
+
+// Package domains (intel-rapl:N) and DRAM subdomains, which the package
+// total does not include; core/uncore subdomains would double count
+static void find_rapl(EnergyMeter *em) {
+    glob_t g;
+
+    if (glob("/sys/class/powercap/intel-rapl:*/energy_uj", 0, NULL, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; i++) {
+            const char *path = g.gl_pathv[i];
+            char file[256], name[48], label[64];
+            double range = 0.0;
+            const char *domain = strstr(path, "intel-rapl:");
+            int subdomain = domain && strchr(domain + strlen("intel-rapl:"), ':') != NULL;
+
+            sibling_path(file, sizeof(file), path, "name");
+            if (read_line(file, name, sizeof(name)) != 0) snprintf(name, sizeof(name), "rapl");
+            if (subdomain && strcmp(name, "dram") != 0) continue;
+
+            sibling_path(file, sizeof(file), path, "max_energy_range_uj");
+            read_number(file, &range);
+            snprintf(label, sizeof(label), "rapl %s", name);
+            add_source(em, path, label, ENERGY_COUNTER, range);
+        }
+        globfree(&g);
+    }
+}
+
+// Board power monitors, common on RISC-V and Arm development boards
+static void find_hwmon(EnergyMeter *em, const char *pattern, EnergySourceKind kind) {
+    glob_t g;
+
+    if (glob(pattern, 0, NULL, &g) == 0) {
+        for (size_t i = 0; i < g.gl_pathc; i++) {
+            const char *path = g.gl_pathv[i];
+            const char *sensor = strrchr(path, '/') + 1;
+            char file[256], chip[32], sensor_label[32], label[64];
+            size_t prefix = strcspn(sensor, "_");
+
+            sibling_path(file, sizeof(file), path, "name");
+            if (read_line(file, chip, sizeof(chip)) != 0) snprintf(chip, sizeof(chip), "hwmon");
+
+            // powerN_label / energyN_label names the rail when present
+            snprintf(label, sizeof(label), "%.*s_label", (int)prefix, sensor);
+            sibling_path(file, sizeof(file), path, label);
+            if (read_line(file, sensor_label, sizeof(sensor_label)) != 0) {
+                snprintf(sensor_label, sizeof(sensor_label), "%.*s", (int)prefix, sensor);
+            }
+            snprintf(label, sizeof(label), "%s %s", chip, sensor_label);
+            add_source(em, path, label, kind, 0.0);
+        }
+        globfree(&g);
+    }
+}
+
+int energy_open(EnergyMeter *em) {
+    memset(em, 0, sizeof(*em));
+    snprintf(em->error, sizeof(em->error), "no RAPL or hwmon power sensors found");
+
+    find_rapl(em);
+    if (em->count == 0) {
+        find_hwmon(em, "/sys/class/hwmon/hwmon*/energy*_input", ENERGY_COUNTER);
+    }
+    if (em->count == 0) {
+        find_hwmon(em, "/sys/class/hwmon/hwmon*/power*_input", ENERGY_POWER);
+    }
+    if (em->count == 0) {
+        find_hwmon(em, "/sys/class/hwmon/hwmon*/power*_average", ENERGY_POWER);
+    }
+    return em->count > 0 ? 0 : -1;
+}
+
+#else
+
+int energy_open(EnergyMeter *em) {
+    memset(em, 0, sizeof(*em));
+    snprintf(em->error, sizeof(em->error), "powercap/hwmon require Linux");
+    return -1;
+}
+
+#endif // __linux__
+
+void energy_read(const EnergyMeter *em, EnergyReading *reading) {
+    for (int i = 0; i < em->count; i++) {
+        if (read_number(em->sources[i].path, &reading->values[i]) != 0) {
+            reading->values[i] = 0.0;
+        }
+    }
+}
+
+double energy_joules(const EnergyMeter *em, const EnergyReading *before,
+                     const EnergyReading *after, double seconds) {
+    double uj = 0.0;
+
+    for (int i = 0; i < em->count; i++) {
+        const EnergySource *src = &em->sources[i];
+        if (src->kind == ENERGY_COUNTER) {
+            double delta = after->values[i] - before->values[i];
+            if (delta < 0.0 && src->max_range_uj > 0.0) delta += src->max_range_uj;
+            if (delta > 0.0) uj += delta;
+        } else {
+            uj += 0.5 * (before->values[i] + after->values[i]) * seconds;
+        }
+    }
+    return uj / 1e6;
+}
+
+// Recorder hooks
+static void recorder_before(void *user) {
+    EnergyRecorder *rec = user;
+    energy_read(rec->meter, &rec->before);
+}
+
+static void recorder_after(void *user, size_t iteration, double seconds) {
+    EnergyRecorder *rec = user;
+    EnergyReading after;
+    (void)iteration;
+
+    energy_read(rec->meter, &after);
+    if (rec->count == rec->capacity) {
+        size_t new_capacity = rec->capacity ? rec->capacity * 2 : 16;
+        double *joules = realloc(rec->joules, new_capacity * sizeof(double));
+        if (!joules) return;
+        rec->joules = joules;
+        rec->capacity = new_capacity;
+    }
+    rec->joules[rec->count++] = energy_joules(rec->meter, &rec->before, &after, seconds);
+}
+
+void energy_recorder_init(EnergyRecorder *rec, const EnergyMeter *em) {
+    memset(rec, 0, sizeof(*rec));
+    rec->meter = em;
+    rec->hook.before_sample = recorder_before;
+    rec->hook.after_sample = recorder_after;
+    rec->hook.user = rec;
+}
+
+void energy_recorder_reset(EnergyRecorder *rec) {
+    rec->count = 0;
+}
+
+void energy_recorder_free(EnergyRecorder *rec) {
+    free(rec->joules);
+    rec->joules = NULL;
+    rec->count = 0;
+    rec->capacity = 0;
+}
+
+// Reporting
+void print_energy_sources(FILE *out, const EnergyMeter *em) {
+    for (int i = 0; i < em->count; i++) {
+        fprintf(out, "%s%s", i ? ", " : "", em->sources[i].label);
+    }
+}
+
+void print_energy_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-12s %-10s %-10s %-10s\n",
+            "Method", "Size", "Energy (mJ)", "Power (W)", "GFLOPS", "GFLOPS/W");
+    fprintf(out, "%-12s %-6s %-12s %-10s %-10s %-10s\n",
+            "------", "----", "-----------", "---------", "------", "--------");
+}
+
+// Totals over all samples, so counters that update every few milliseconds
+// still give a usable average for short kernels
+void print_energy_result(FILE *out, const char *method, size_t matrix_size,
+                         const double *joules, const BenchResult *result) {
+    double total_joules = 0.0;
+    double total_seconds = 0.0;
+
+    if (!joules || result->count == 0) {
+        fprintf(out, "%-12s %-6zu (not measured)\n", method, matrix_size);
+        return;
+    }
+    for (size_t i = 0; i < result->count; i++) {
+        total_joules += joules[i];
+        total_seconds += result->samples[i];
+    }
+    if (total_joules <= 0.0) {
+        fprintf(out, "%-12s %-6zu (no energy recorded; run longer)\n", method, matrix_size);
+        return;
+    }
+
+    double flops = 2.0 * (double)matrix_size * matrix_size * matrix_size * (double)result->count;
+    double gflops = flops / (total_seconds * 1e9);
+    fprintf(out, "%-12s %-6zu %-12.3f %-10.2f %-10.2f %-10.3f\n",
+            method, matrix_size, total_joules * 1000.0 / (double)result->count,
+            total_joules / total_seconds, gflops, flops / (total_joules * 1e9));
+}
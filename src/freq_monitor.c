@@ -0,0 +1,328 @@
+#include "freq_monitor.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#endif
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+#ifdef __linux__
+
+// Shared between the benchmark thread and the polling thread
+typedef struct {
+    FreqMonitor *fm;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int active;
+    int stop;
+    double sum_khz;
+    double min_khz;
+    double max_khz;
+    double max_temp_c;
+    int freq_polls;
+    int polls;
+} FreqSampler;
+
+static int read_fd_number(int fd, double *value) {
+    char buf[32];
+    ssize_t len = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (len <= 0) return -1;
+    buf[len] = '\0';
+    *value = strtod(buf, NULL);
+    return 0;
+}
+
+// One poll: fastest CPU and hottest zone. Caller holds the lock.
+static void poll_once(FreqSampler *s) {
+    FreqMonitor *fm = s->fm;
+    double khz = 0.0, temp = 0.0, value;
+
+    for (int i = 0; i < fm->num_cpus; i++) {
+        if (read_fd_number(fm->freq_fds[i], &value) == 0 && value > khz) khz = value;
+    }
+    for (int i = 0; i < fm->num_zones; i++) {
+        if (read_fd_number(fm->zone_fds[i], &value) == 0 && value / 1000.0 > temp) {
+            temp = value / 1000.0;
+        }
+    }
+
+    if (khz > 0.0) {
+        s->sum_khz += khz;
+        if (s->freq_polls == 0 || khz < s->min_khz) s->min_khz = khz;
+        if (khz > s->max_khz) s->max_khz = khz;
+        s->freq_polls++;
+    }
+    if (temp > s->max_temp_c) s->max_temp_c = temp;
+    s->polls++;
+}
+
+static void* sampler_main(void *arg) {
+    FreqSampler *s = arg;
+    struct timespec interval;
+
+    interval.tv_sec = (time_t)(s->fm->interval_ms / 1000.0);
+    interval.tv_nsec = (long)((s->fm->interval_ms - interval.tv_sec * 1000.0) * 1e6);
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        while (!s->active && !s->stop) {
+            pthread_cond_wait(&s->wake, &s->lock);
+        }
+        if (s->stop) break;
+
+        pthread_mutex_unlock(&s->lock);
+        nanosleep(&interval, NULL);
+        pthread_mutex_lock(&s->lock);
+        if (s->active) poll_once(s);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+int freq_monitor_open(FreqMonitor *fm, double interval_ms) {
+    char path[128];
+
+    memset(fm, 0, sizeof(*fm));
+    fm->interval_ms = interval_ms > 0.0 ? interval_ms : 10.0;
+
+    for (int cpu = 0; cpu < MAX_THREADS; cpu++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpu);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) continue;
+        fm->freq_fds[fm->num_cpus++] = fd;
+    }
+    for (int zone = 0; zone < 64 && fm->num_zones < FREQ_MAX_ZONES; zone++) {
+        snprintf(path, sizeof(path), "/sys/class/thermal/thermal_zone%d/temp", zone);
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) continue;
+        fm->zone_fds[fm->num_zones++] = fd;
+    }
+    if (fm->num_cpus == 0 && fm->num_zones == 0) {
+        snprintf(fm->error, sizeof(fm->error), "no cpufreq or thermal zones in sysfs");
+        return -1;
+    }
+
+    FreqSampler *s = calloc(1, sizeof(FreqSampler));
+    if (!s) {
+        freq_monitor_close(fm);
+        snprintf(fm->error, sizeof(fm->error), "out of memory");
+        return -1;
+    }
+    s->fm = fm;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->wake, NULL);
+    if (pthread_create(&s->thread, NULL, sampler_main, s) != 0) {
+        pthread_mutex_destroy(&s->lock);
+        pthread_cond_destroy(&s->wake);
+        free(s);
+        freq_monitor_close(fm);
+        snprintf(fm->error, sizeof(fm->error), "cannot start sampling thread");
+        return -1;
+    }
+    fm->sampler = s;
+    return 0;
+}
+
+void freq_monitor_close(FreqMonitor *fm) {
+    FreqSampler *s = fm->sampler;
+
+    if (s) {
+        pthread_mutex_lock(&s->lock);
+        s->stop = 1;
+        pthread_cond_signal(&s->wake);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+        pthread_mutex_destroy(&s->lock);
+        pthread_cond_destroy(&s->wake);
+        free(s);
+        fm->sampler = NULL;
+    }
+    for (int i = 0; i < fm->num_cpus; i++) close(fm->freq_fds[i]);
+    for (int i = 0; i < fm->num_zones; i++) close(fm->zone_fds[i]);
+    fm->num_cpus = 0;
+    fm->num_zones = 0;
+}
+
+// Polls once at each edge so short samples still get a reading
+void freq_monitor_begin(FreqMonitor *fm) {
+    FreqSampler *s = fm->sampler;
+
+    pthread_mutex_lock(&s->lock);
+    s->sum_khz = 0.0;
+    s->min_khz = 0.0;
+    s->max_khz = 0.0;
+    s->max_temp_c = 0.0;
+    s->freq_polls = 0;
+    s->polls = 0;
+    poll_once(s);
+    s->active = 1;
+    pthread_cond_signal(&s->wake);
+    pthread_mutex_unlock(&s->lock);
+}
+
+void freq_monitor_end(FreqMonitor *fm, FreqSample *sample) {
+    FreqSampler *s = fm->sampler;
+
+    pthread_mutex_lock(&s->lock);
+    s->active = 0;
+    poll_once(s);
+    sample->mean_khz = s->freq_polls ? s->sum_khz / s->freq_polls : 0.0;
+    sample->min_khz = s->min_khz;
+    sample->max_khz = s->max_khz;
+    sample->max_temp_c = s->max_temp_c;
+    sample->polls = s->polls;
+    sample->stable = 1;
+    pthread_mutex_unlock(&s->lock);
+}
+
+#else
+
+int freq_monitor_open(FreqMonitor *fm, double interval_ms) {
+    memset(fm, 0, sizeof(*fm));
+    fm->interval_ms = interval_ms;
+    snprintf(fm->error, sizeof(fm->error), "cpufreq monitoring requires Linux");
+    return -1;
+}
+
+void freq_monitor_close(FreqMonitor *fm) {
+    (void)fm;
+}
+
+void freq_monitor_begin(FreqMonitor *fm) {
+    (void)fm;
+}
+
+void freq_monitor_end(FreqMonitor *fm, FreqSample *sample) {
+    (void)fm;
+    memset(sample, 0, sizeof(*sample));
+    sample->stable = 1;
+}
+
+#endif // __linux__
+
+// Recorder hooks
+static void recorder_before(void *user) {
+    FreqRecorder *rec = user;
+    freq_monitor_begin(rec->monitor);
+}
+
+static void recorder_after(void *user, size_t iteration, double seconds) {
+    FreqRecorder *rec = user;
+    FreqSample sample;
+    (void)iteration;
+    (void)seconds;
+
+    freq_monitor_end(rec->monitor, &sample);
+    if (rec->count == rec->capacity) {
+        size_t new_capacity = rec->capacity ? rec->capacity * 2 : 16;
+        FreqSample *samples = realloc(rec->samples, new_capacity * sizeof(FreqSample));
+        if (!samples) return;
+        rec->samples = samples;
+        rec->capacity = new_capacity;
+    }
+    rec->samples[rec->count++] = sample;
+}
+
+void freq_recorder_init(FreqRecorder *rec, FreqMonitor *fm) {
+    memset(rec, 0, sizeof(*rec));
+    rec->monitor = fm;
+    rec->hook.before_sample = recorder_before;
+    rec->hook.after_sample = recorder_after;
+    rec->hook.user = rec;
+}
+
+void freq_recorder_reset(FreqRecorder *rec) {
+    rec->count = 0;
+}
+
+void freq_recorder_free(FreqRecorder *rec) {
+    free(rec->samples);
+    rec->samples = NULL;
+    rec->count = 0;
+    rec->capacity = 0;
+}
+
+size_t freq_mark_stable(FreqSample *samples, size_t count, double threshold) {
+    double *khz = malloc(count * sizeof(double));
+    size_t known = 0, unstable = 0;
+
+    if (!khz) return 0;
+    for (size_t i = 0; i < count; i++) {
+        samples[i].stable = 1;
+        if (samples[i].mean_khz > 0.0) khz[known++] = samples[i].mean_khz;
+    }
+    if (known > 0) {
+        qsort(khz, known, sizeof(double), compare_double);
+        double reference = bench_percentile(khz, known, 0.5);
+
+        for (size_t i = 0; i < count; i++) {
+            const FreqSample *s = &samples[i];
+            if (s->mean_khz <= 0.0) continue;
+            double drift = (s->mean_khz - reference) / reference;
+            double spread = (s->max_khz - s->min_khz) / reference;
+            if (drift > threshold || drift < -threshold || spread > threshold) {
+                samples[i].stable = 0;
+                unstable++;
+            }
+        }
+    }
+    free(khz);
+    return unstable;
+}
+
+// Reporting
+void print_stability_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-9s %-10s %-10s %-10s %-10s %-10s\n",
+            "Method", "Size", "Unstable", "Mean MHz", "Min MHz", "Max MHz", "Max C", "Cyc/FMA");
+    fprintf(out, "%-12s %-6s %-9s %-10s %-10s %-10s %-10s %-10s\n",
+            "------", "----", "--------", "--------", "-------", "-------", "-----", "-------");
+}
+
+// Cycles per FMA use each sample's own measured clock, so throttled
+// samples are normalized rather than just slower
+void print_stability_result(FILE *out, const char *method, size_t matrix_size,
+                            const FreqSample *samples, const BenchResult *result) {
+    size_t count = result->count;
+    size_t unstable = 0, known = 0;
+    double sum_khz = 0.0, min_khz = 0.0, max_khz = 0.0, max_temp = 0.0;
+    double *cycles = malloc((count ? count : 1) * sizeof(double));
+    double fmas = (double)matrix_size * matrix_size * matrix_size;
+
+    if (!samples || !cycles) {
+        fprintf(out, "%-12s %-6zu (not measured)\n", method, matrix_size);
+        free(cycles);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const FreqSample *s = &samples[i];
+        if (!s->stable) unstable++;
+        if (s->max_temp_c > max_temp) max_temp = s->max_temp_c;
+        if (s->mean_khz <= 0.0) continue;
+        sum_khz += s->mean_khz;
+        if (known == 0 || s->min_khz < min_khz) min_khz = s->min_khz;
+        if (s->max_khz > max_khz) max_khz = s->max_khz;
+        cycles[known++] = result->samples[i] * s->mean_khz * 1e3 / fmas;
+    }
+
+    if (known == 0) {
+        fprintf(out, "%-12s %-6zu %-9zu %-10s %-10s %-10s %-10.1f %-10s\n",
+                method, matrix_size, unstable, "n/a", "n/a", "n/a", max_temp, "n/a");
+    } else {
+        qsort(cycles, known, sizeof(double), compare_double);
+        fprintf(out, "%-12s %-6zu %-9zu %-10.0f %-10.0f %-10.0f %-10.1f %-10.3f\n",
+                method, matrix_size, unstable, sum_khz / known / 1e3, min_khz / 1e3,
+                max_khz / 1e3, max_temp, bench_percentile(cycles, known, 0.5));
+    }
+    free(cycles);
+}
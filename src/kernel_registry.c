@@ -0,0 +1,124 @@
+#include "kernel_registry.h"
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+static const KernelInfo *registry[KERNEL_REGISTRY_MAX];
+static size_t registry_count;
+
+// Constructors run in link order, so keep the table sorted as it fills
+void kernel_register(const KernelInfo *info) {
+    size_t pos = registry_count;
+
+    if (registry_count == KERNEL_REGISTRY_MAX) {
+        fprintf(stderr, "Warning: Kernel registry full, '%s' not registered\n", info->name);
+        return;
+    }
+    while (pos > 0 && registry[pos - 1]->order > info->order) {
+        registry[pos] = registry[pos - 1];
+        pos--;
+    }
+    registry[pos] = info;
+    registry_count++;
+}
+
+size_t kernel_count(void) {
+    return registry_count;
+}
+
+const KernelInfo* kernel_get(size_t index) {
+    return index < registry_count ? registry[index] : NULL;
+}
+
+const KernelInfo* kernel_find(const char *name) {
+    for (size_t k = 0; k < registry_count; k++) {
+        if (strcasecmp(name, registry[k]->name) == 0) return registry[k];
+    }
+    return NULL;
+}
+
+int kernel_name_matches(const char *pattern, const char *name) {
+    if (*pattern == '\0') return *name == '\0';
+    if (*pattern == '*') {
+        for (;;) {
+            if (kernel_name_matches(pattern + 1, name)) return 1;
+            if (*name == '\0') return 0;
+            name++;
+        }
+    }
+    if (*name == '\0') return 0;
+    if (*pattern != '?' && tolower((unsigned char)*pattern) != tolower((unsigned char)*name)) {
+        return 0;
+    }
+    return kernel_name_matches(pattern + 1, name + 1);
+}
+
+size_t kernel_select(const char *list, const KernelInfo **out, size_t max,
+                     char *unmatched, size_t unmatched_len) {
+    int wanted[KERNEL_REGISTRY_MAX] = { 0 };
+    int select_all = !list || list[0] == '\0';
+    size_t count = 0;
+
+    if (unmatched && unmatched_len) unmatched[0] = '\0';
+
+    while (list && *list) {
+        char pattern[64];
+        size_t len = strcspn(list, ",");
+        int matched = 0;
+
+        if (len > 0 && len < sizeof(pattern)) {
+            memcpy(pattern, list, len);
+            pattern[len] = '\0';
+            for (size_t k = 0; k < registry_count; k++) {
+                if (kernel_name_matches(pattern, registry[k]->name)) {
+                    wanted[k] = 1;
+                    matched = 1;
+                }
+            }
+            if (!matched && unmatched) {
+                size_t used = strlen(unmatched);
+                snprintf(unmatched + used, unmatched_len - used, "%s%s", used ? "," : "", pattern);
+            }
+        }
+        list += len;
+        if (*list == ',') list++;
+    }
+
+    for (size_t k = 0; k < registry_count && count < max; k++) {
+        if (select_all || wanted[k]) out[count++] = registry[k];
+    }
+    return count;
+}
+
+static void format_flags(char *buf, size_t len, unsigned flags) {
+    static const struct { unsigned flag; const char *name; } params[] = {
+        { KERNEL_USES_TILE, "tile" },
+        { KERNEL_USES_THREADS, "threads" },
+        { KERNEL_USES_PREFETCH, "prefetch" },
+    };
+    size_t used = 0;
+
+    buf[0] = '\0';
+    for (size_t p = 0; p < sizeof(params) / sizeof(params[0]) && used < len; p++) {
+        if (flags & params[p].flag) {
+            used += snprintf(buf + used, len - used, "%s%s", used ? "," : "", params[p].name);
+        }
+    }
+    if (buf[0] == '\0') snprintf(buf, len, "-");
+}
+
+void print_kernel_list(FILE *out) {
+    fprintf(out, "%-12s %-8s %-6s %-8s %-15s %s\n",
+            "Kernel", "ISA", "Types", "Shapes", "Parameters", "Description");
+    fprintf(out, "%-12s %-8s %-6s %-8s %-15s %s\n",
+            "------", "---", "-----", "------", "----------", "-----------");
+    for (size_t k = 0; k < registry_count; k++) {
+        const KernelInfo *info = registry[k];
+        char params[32];
+
+        format_flags(params, sizeof(params), info->flags);
+        fprintf(out, "%-12s %-8s %-6s %-8s %-15s %s\n", info->name, info->isa,
+                info->dtypes & KERNEL_DTYPE_F64 ? "f64" : "-",
+                info->shapes & KERNEL_SHAPE_RECT ? "any" : "square", params, info->description);
+    }
+}
@@ -1,9 +1,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include "matrix.h"
 #include "utils.h"
+#include "config.h"
+#include "benchmark.h"
+#include "report.h"
+#include "compare.h"
+#include "sweep.h"
+#include "scaling.h"
+#include "kernel_registry.h"
+#include "uarch_probe.h"
+#include "perf_model.h"
+#include "perf_counters.h"
+#include "energy.h"
+#include "cache_control.h"
+#include "freq_monitor.h"
+#include "phase_timing.h"
+#include "roofline.h"
+#include "trace.h"
 
 // Default matrix size if not specified
 #define DEFAULT_MATRIX_SIZE 512
@@ -11,24 +28,714 @@
 // Tolerance for verification
 #define VERIFICATION_TOLERANCE 1e-10
 
+// Cache state set up before every call but the first
+typedef struct {
+    CacheMode mode;
+    CacheFlusher flusher;
+    const KernelArgs *args;
+    const KernelArgs *paired_args;  // The other kernel's operands in --ab, or NULL
+} CachePrep;
+
+static void touch_operands(const KernelArgs *args) {
+    const Matrix *b = args->Bt ? args->Bt : args->B;
+    cache_touch(args->A->data, args->A->rows * args->A->cols * sizeof(double), 0);
+    cache_touch(b->data, b->rows * b->cols * sizeof(double), 0);
+    cache_touch(args->C->data, args->C->rows * args->C->cols * sizeof(double), 1);
+}
+
+// Paired runs cannot tell which kernel comes next, so both operand sets
+// are touched before each sample
+static void prepare_caches(void *user) {
+    CachePrep *prep = user;
+
+    if (prep->mode == CACHE_COLD) {
+        cache_flush(&prep->flusher);
+        return;
+    }
+    if (prep->paired_args) touch_operands(prep->paired_args);
+    touch_operands(prep->args);
+}
+
+// B in the layout a kernel reads: KERNEL_TRANSPOSED_B kernels get Bt, built
+// untimed as if the caller already held B transposed
+static const Matrix* transposed_operand(const KernelInfo *kernel, const Matrix *Bt) {
+    return (kernel->flags & KERNEL_TRANSPOSED_B) ? Bt : NULL;
+}
+
+static int any_transposed_b(const KernelInfo **kernels, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        if (kernels[k]->flags & KERNEL_TRANSPOSED_B) return 1;
+    }
+    return 0;
+}
+
+// Re-run every configuration in a baseline file and test for regressions.
+// Returns 0 when nothing regressed, 2 on regression and 1 on error.
+static int run_compare(const char *baseline_path, const CompareConfig *compare_cfg,
+                       const BenchConfig *bench_cfg, CachePrep *prep,
+                       Matrix* (*create)(size_t, size_t), Report *report, FILE *console) {
+    Baseline baseline;
+    Matrix *A = NULL, *B = NULL, *C = NULL, *Bt = NULL;
+    size_t current_size = 0;
+    int regressions = 0;
+    int status = 0;
+
+    if (baseline_load(baseline_path, &baseline) != 0) return 1;
+
+    fprintf(console, "Comparing against %s (%zu configurations, alpha %.3f, threshold %.1f%%)\n",
+            baseline_path, baseline.count, compare_cfg->alpha, compare_cfg->threshold * 100.0);
+    print_compare_header(console);
+
+    for (size_t i = 0; i < baseline.count; i++) {
+        const BaselineEntry *entry = &baseline.entries[i];
+        const KernelInfo *kc = kernel_find(entry->kernel);
+
+        if (!kc || (entry->threads != 1 && !(kc->flags & KERNEL_USES_THREADS)) ||
+            entry->threads < 1 || entry->threads > MAX_THREADS || entry->size < MIN_MATRIX_SIZE) {
+            fprintf(console, "%-12s %-6zu skipped (not available in this build)\n",
+                    entry->kernel, entry->size);
+            continue;
+        }
+
+        // Inputs are regenerated with the same seed whenever the size changes
+        if (entry->size != current_size) {
+            matrix_destroy(A);
+            matrix_destroy(B);
+            matrix_destroy(C);
+            matrix_destroy(Bt);
+            Bt = NULL;
+            A = create(entry->size, entry->size);
+            B = create(entry->size, entry->size);
+            C = create(entry->size, entry->size);
+            if (!A || !B || !C) {
+                fprintf(stderr, "Error: Failed to allocate %zux%zu matrices\n", entry->size, entry->size);
+                status = 1;
+                break;
+            }
+            seed_random(42);
+            matrix_init_random(A, -1.0, 1.0);
+            matrix_init_random(B, -1.0, 1.0);
+            matrix_init_zero(C);
+            current_size = entry->size;
+        }
+        if ((kc->flags & KERNEL_TRANSPOSED_B) && !Bt) {
+            Bt = create(entry->size, entry->size);
+            if (!Bt) {
+                fprintf(stderr, "Error: Failed to allocate %zux%zu matrices\n", entry->size, entry->size);
+                status = 1;
+                break;
+            }
+            matrix_transpose(B, Bt);
+        }
+
+        KernelArgs args = { A, B, C, entry->tile ? entry->tile : DEFAULT_TILE_SIZE, entry->threads,
+                            transposed_operand(kc, Bt) };
+        BenchResult result;
+        CompareResult verdict;
+
+        prep->args = &args;
+        if (bench_run(bench_cfg, kc->run, &args, &result) != 0) {
+            fprintf(stderr, "Error: Failed to record benchmark samples\n");
+            status = 1;
+            break;
+        }
+
+        compare_samples(compare_cfg, result.samples, result.count,
+                        entry->samples, entry->count, &verdict);
+        print_compare_result(console, entry, result.stats.median, &verdict);
+        if (verdict.verdict == COMPARE_REGRESSED) regressions++;
+
+        ReportRecord record = { kc->name, entry->size, entry->tile, entry->threads, NULL, NULL, NULL };
+        report_kernel(report, &record, &result);
+        bench_result_free(&result);
+    }
+
+    prep->args = NULL;
+    matrix_destroy(A);
+    matrix_destroy(B);
+    matrix_destroy(C);
+    matrix_destroy(Bt);
+    baseline_free(&baseline);
+
+    if (status != 0) return status;
+    if (regressions > 0) {
+        fprintf(console, "\n%d configuration(s) regressed\n", regressions);
+        return 2;
+    }
+    fprintf(console, "\nNo regressions detected\n");
+    return 0;
+}
+
+// Run every configuration of a sweep in this process. Inputs are allocated
+// once at the largest size and viewed at each smaller one, and the naive
+// reference used by --verify is computed once per size.
+// Returns 0 on success and 1 on error or a verification failure.
+static int run_sweep(const SweepSpec *spec, const BenchConfig *bench_cfg, CachePrep *prep,
+                     Matrix* (*create)(size_t, size_t), int verify, ModelValidation *model,
+                     Report *report, FILE *console) {
+    const KernelInfo *selected[KERNEL_REGISTRY_MAX];
+    char unmatched[256];
+    size_t num_selected = kernel_select(spec->kernels, selected, KERNEL_REGISTRY_MAX,
+                                        unmatched, sizeof(unmatched));
+    size_t max_size = sweep_max_size(spec);
+    size_t configs = 0, failures = 0;
+    int status = 0;
+    Timer total;
+
+    if (unmatched[0]) {
+        fprintf(console, "Warning: No kernel in this build matches '%s', skipped\n", unmatched);
+    }
+    if (num_selected == 0) {
+        fprintf(stderr, "Error: No kernels selected for the sweep\n");
+        return 1;
+    }
+    if (max_size < MIN_MATRIX_SIZE) {
+        fprintf(stderr, "Error: Matrix size must be at least %d\n", MIN_MATRIX_SIZE);
+        return 1;
+    }
+
+    Matrix *A = create(max_size, max_size);
+    Matrix *B = create(max_size, max_size);
+    Matrix *C = create(max_size, max_size);
+    Matrix *ref = verify ? create(max_size, max_size) : NULL;
+    int transposed = any_transposed_b(selected, num_selected);
+    Matrix *Bt = transposed ? create(max_size, max_size) : NULL;
+    if (!A || !B || !C || (verify && !ref) || (transposed && !Bt)) {
+        fprintf(stderr, "Error: Failed to allocate %zux%zu matrices\n", max_size, max_size);
+        matrix_destroy(A);
+        matrix_destroy(B);
+        matrix_destroy(C);
+        matrix_destroy(ref);
+        matrix_destroy(Bt);
+        return 1;
+    }
+
+    fprintf(console, "Sweeping %zu sizes x %zu tiles x %zu thread counts over %zu kernels\n",
+            spec->num_sizes, spec->num_tiles, spec->num_threads, num_selected);
+    print_sweep_header(console);
+    timer_start(&total);
+
+    for (size_t s = 0; s < spec->num_sizes && status == 0; s++) {
+        size_t n = spec->sizes[s];
+        Matrix a = *A, b = *B, c = *C, r = verify ? *ref : *C, bt = transposed ? *Bt : *B;
+
+        if (n < MIN_MATRIX_SIZE) {
+            fprintf(console, "%-12s %-6zu skipped (below minimum size)\n", "-", n);
+            continue;
+        }
+
+        // Same seed and fill order as a standalone run of this size
+        a.rows = a.cols = b.rows = b.cols = c.rows = c.cols = r.rows = r.cols = n;
+        bt.rows = bt.cols = n;
+        seed_random(42);
+        matrix_init_random(&a, -1.0, 1.0);
+        matrix_init_random(&b, -1.0, 1.0);
+        if (transposed) {
+            matrix_transpose(&b, &bt);
+        }
+        if (verify) {
+            matrix_mult_naive(&a, &b, &r);
+        }
+
+        for (size_t k = 0; k < num_selected && status == 0; k++) {
+            const KernelInfo *kc = selected[k];
+            int uses_tile = (kc->flags & KERNEL_USES_TILE) != 0;
+            int uses_threads = (kc->flags & KERNEL_USES_THREADS) != 0;
+            size_t num_tiles = uses_tile ? spec->num_tiles : 1;
+            size_t num_threads = uses_threads ? spec->num_threads : 1;
+
+            for (size_t t = 0; t < num_tiles && status == 0; t++) {
+                size_t tile = spec->tiles[t] < n ? spec->tiles[t] : n;
+                int repeated = 0;
+
+                // Tiles clamped to the matrix size collapse into one configuration
+                for (size_t u = 0; u < t; u++) {
+                    repeated |= (spec->tiles[u] < n ? spec->tiles[u] : n) == tile;
+                }
+                if (repeated) continue;
+
+                for (size_t j = 0; j < num_threads; j++) {
+                    int threads = uses_threads ? spec->threads[j] : 1;
+                    KernelArgs args = { &a, &b, &c, tile, threads, transposed_operand(kc, &bt) };
+                    BenchResult result;
+                    int verified = -1;
+
+                    prep->args = &args;
+                    if (bench_run(bench_cfg, kc->run, &args, &result) != 0) {
+                        fprintf(stderr, "Error: Failed to record benchmark samples\n");
+                        status = 1;
+                        break;
+                    }
+                    if (verify) {
+                        verified = matrix_verify(&r, &c, VERIFICATION_TOLERANCE);
+                        if (!verified) failures++;
+                    }
+                    print_sweep_result(console, kc->name, n, uses_tile ? tile : 0,
+                                       threads, &result, verified);
+                    if (model && model_validation_add(model, kc->name, kc->blocking, n,
+                                                      uses_tile ? tile : 0, threads,
+                                                      result.stats.median) != 0) {
+                        fprintf(stderr, "Error: Out of memory recording model points\n");
+                        status = 1;
+                    }
+
+                    ReportRecord record = { kc->name, n, uses_tile ? tile : 0, threads,
+                                            NULL, NULL, NULL };
+                    report_kernel(report, &record, &result);
+                    bench_result_free(&result);
+                    configs++;
+                }
+            }
+        }
+    }
+
+    timer_stop(&total);
+    prep->args = NULL;
+    matrix_destroy(A);
+    matrix_destroy(B);
+    matrix_destroy(C);
+    matrix_destroy(ref);
+    matrix_destroy(Bt);
+
+    fprintf(console, "\n%zu configurations in %.2f s", configs, timer_elapsed_seconds(&total));
+    if (verify) {
+        fprintf(console, ", %zu verification failure%s", failures, failures == 1 ? "" : "s");
+    }
+    fprintf(console, "\n");
+    return status != 0 || failures > 0;
+}
+
+// Run one threaded kernel at 1..max_threads threads, first for a fixed
+// size (strong scaling) and then with the size grown so that the work per
+// thread stays constant (weak scaling). A threaded STREAM triad at each
+// count shows where memory bandwidth stops growing.
+// Returns 0 on success and 1 on error.
+static int run_scaling(const KernelInfo *kernel, size_t size, size_t tile, int max_threads,
+                       const BenchConfig *bench_cfg, CachePrep *prep,
+                       Matrix* (*create)(size_t, size_t), const char *csv_path, FILE *console) {
+    size_t max_size = scaling_weak_size(size, max_threads);
+    size_t count = 0;
+    size_t llc = get_cache_size(3) ? get_cache_size(3) : get_cache_size(2);
+    ScalingPoint *points = calloc(2 * (size_t)max_threads, sizeof(ScalingPoint));
+    double *stream_gbs = calloc((size_t)max_threads + 1, sizeof(double));
+    ScalingStream stream;
+    int status = 0;
+
+    Matrix *A = create(max_size, max_size);
+    Matrix *B = create(max_size, max_size);
+    Matrix *C = create(max_size, max_size);
+    if (!points || !stream_gbs || !A || !B || !C || scaling_stream_init(&stream, 0) != 0) {
+        fprintf(stderr, "Error: Failed to allocate scaling buffers\n");
+        free(points);
+        free(stream_gbs);
+        matrix_destroy(A);
+        matrix_destroy(B);
+        matrix_destroy(C);
+        return 1;
+    }
+
+    fprintf(console, "Scaling %s from 1 to %d threads (strong: size %zu, weak: %zu to %zu)\n",
+            kernel->name, max_threads, size, size, max_size);
+    fprintf(console, "Measuring threaded triad bandwidth...\n");
+    for (int t = 1; t <= max_threads; t++) {
+        stream_gbs[t] = scaling_stream_measure(&stream, t, SCALING_STREAM_SECONDS);
+    }
+    scaling_stream_free(&stream);
+    print_scaling_header(console);
+
+    for (int m = 0; m < 2 && status == 0; m++) {
+        ScalingMode mode = m == 0 ? SCALING_STRONG : SCALING_WEAK;
+        size_t current = 0;
+        Matrix a = *A, b = *B, c = *C;
+
+        for (int t = 1; t <= max_threads; t++) {
+            size_t n = mode == SCALING_STRONG ? size : scaling_weak_size(size, t);
+            size_t n_tile = tile < n ? tile : n;
+            KernelArgs args = { &a, &b, &c, n_tile, t, NULL };
+            BenchResult result;
+            ScalingPoint *point = &points[count];
+
+            // Same inputs as a standalone run of this size
+            if (n != current) {
+                a.rows = a.cols = b.rows = b.cols = c.rows = c.cols = n;
+                seed_random(42);
+                matrix_init_random(&a, -1.0, 1.0);
+                matrix_init_random(&b, -1.0, 1.0);
+                current = n;
+            }
+
+            prep->args = &args;
+            if (bench_run(bench_cfg, kernel->run, &args, &result) != 0) {
+                fprintf(stderr, "Error: Failed to record benchmark samples\n");
+                status = 1;
+                break;
+            }
+            point->mode = mode;
+            point->kernel = kernel->name;
+            point->threads = t;
+            point->size = n;
+            point->tile = n_tile;
+            point->seconds = result.stats.median;
+            point->gflops = calculate_gflops(n, result.stats.median);
+            point->kernel_gbs = kernel->traffic
+                ? kernel->traffic(n, n_tile, llc) / (result.stats.median * 1e9) : 0.0;
+            point->stream_gbs = stream_gbs[t];
+            bench_result_free(&result);
+            count++;
+
+            // Speedups need the 1-thread point, which is always first
+            scaling_finish(points, count);
+            print_scaling_point(console, point);
+        }
+    }
+    prep->args = NULL;
+    matrix_destroy(A);
+    matrix_destroy(B);
+    matrix_destroy(C);
+
+    if (status == 0) {
+        int sat = scaling_saturation(points, count, SCALING_STRONG, SCALING_SATURATION);
+        int last_efficient = 0;
+
+        for (size_t i = 0; i < count && points[i].mode == SCALING_STRONG; i++) {
+            if (points[i].efficiency < 0.5) break;
+            last_efficient = points[i].threads;
+        }
+        fprintf(console, "\nStrong scaling efficiency stays at or above 50%% up to %d thread%s\n",
+                last_efficient, last_efficient == 1 ? "" : "s");
+        if (sat >= 0) {
+            fprintf(console, "Memory bandwidth saturates at %d thread%s (%.2f GB/s triad)\n",
+                    points[sat].threads, points[sat].threads == 1 ? "" : "s", points[sat].stream_gbs);
+        }
+
+        if (csv_path) {
+            FILE *f = fopen(csv_path, "w");
+            if (!f) {
+                fprintf(stderr, "Error: Cannot open scaling output '%s'\n", csv_path);
+                status = 1;
+            } else {
+                write_scaling_csv(f, points, count);
+                fclose(f);
+                fprintf(console, "Scaling data written to %s\n", csv_path);
+            }
+        } else {
+            fprintf(console, "\n");
+            write_scaling_csv(console, points, count);
+        }
+    }
+    free(points);
+    free(stream_gbs);
+    return status;
+}
+
+// Time kernel_b against kernel_a in alternation on the same inputs and
+// report the speedup of b with a bootstrap confidence interval.
+// Returns 0 on success, 1 on error and 2 when the outputs differ.
+static int run_ab(const KernelInfo *kernel_a, const KernelInfo *kernel_b, size_t size,
+                  size_t tile, int threads, const BenchConfig *bench_cfg, CachePrep *prep,
+                  Matrix* (*create)(size_t, size_t), Report *report, FILE *console) {
+    Matrix *A = create(size, size);
+    Matrix *B = create(size, size);
+    Matrix *C_a = create(size, size);
+    Matrix *C_b = create(size, size);
+    const KernelInfo *pair[2] = { kernel_a, kernel_b };
+    Matrix *Bt = any_transposed_b(pair, 2) ? create(size, size) : NULL;
+    BenchResult result_a, result_b;
+    PairedResult paired;
+    int status = 0;
+
+    if (!A || !B || !C_a || !C_b || (any_transposed_b(pair, 2) && !Bt)) {
+        fprintf(stderr, "Error: Failed to allocate %zux%zu matrices\n", size, size);
+        status = 1;
+        goto done;
+    }
+    seed_random(42);
+    matrix_init_random(A, -1.0, 1.0);
+    matrix_init_random(B, -1.0, 1.0);
+    if (Bt) {
+        matrix_transpose(B, Bt);
+    }
+
+    KernelArgs args_a = { A, B, C_a, tile, threads, transposed_operand(kernel_a, Bt) };
+    KernelArgs args_b = { A, B, C_b, tile, threads, transposed_operand(kernel_b, Bt) };
+
+    // Warm mode touches the operands of both kernels, so a pair that reads
+    // B and Bt, or writes C_a and C_b, starts both sides warm
+    prep->args = &args_a;
+    prep->paired_args = &args_b;
+    fprintf(console, "Interleaving %s and %s...\n", kernel_a->name, kernel_b->name);
+    if (bench_run_paired(bench_cfg, kernel_a->run, &args_a, kernel_b->run, &args_b,
+                         &result_a, &result_b) != 0) {
+        fprintf(stderr, "Error: Failed to record benchmark samples\n");
+        status = 1;
+        goto done;
+    }
+
+    print_benchmark_header(console);
+    print_benchmark_result(console, kernel_a->name, size, &result_a);
+    print_benchmark_result(console, kernel_b->name, size, &result_b);
+
+    ReportRecord record_a = { kernel_a->name, size, (kernel_a->flags & KERNEL_USES_TILE) ? tile : 0,
+                              (kernel_a->flags & KERNEL_USES_THREADS) ? threads : 1, NULL, NULL, NULL };
+    ReportRecord record_b = { kernel_b->name, size, (kernel_b->flags & KERNEL_USES_TILE) ? tile : 0,
+                              (kernel_b->flags & KERNEL_USES_THREADS) ? threads : 1, NULL, NULL, NULL };
+    report_kernel(report, &record_a, &result_a);
+    report_kernel(report, &record_b, &result_b);
+
+    if (compare_paired_bootstrap(result_a.samples, result_b.samples, result_a.count,
+                                 COMPARE_BOOTSTRAP_RESAMPLES, &paired) == 0) {
+        print_paired_result(console, kernel_a->name, kernel_b->name, &paired);
+    } else {
+        fprintf(console, "\nNo confidence interval (needs at least 2 pairs of positive times)\n");
+    }
+
+    // An optimization is only worth adopting if it computes the same thing
+    if (!matrix_verify(C_a, C_b, VERIFICATION_TOLERANCE)) {
+        fprintf(console, "✗ %s and %s results differ!\n", kernel_a->name, kernel_b->name);
+        status = 2;
+    } else {
+        fprintf(console, "✓ %s and %s results match\n", kernel_a->name, kernel_b->name);
+    }
+    bench_result_free(&result_a);
+    bench_result_free(&result_b);
+
+done:
+    prep->args = NULL;
+    prep->paired_args = NULL;
+    matrix_destroy(A);
+    matrix_destroy(B);
+    matrix_destroy(C_a);
+    matrix_destroy(C_b);
+    matrix_destroy(Bt);
+    return status;
+}
+
+// Distances tried by --prefetch auto, in k iterations, and the fewest
+// pairs timed against distance 0 for each
+static const size_t prefetch_candidates[] = { 0, 2, 4, 8, 16, 32, 64 };
+
+#define NUM_PREFETCH_CANDIDATES (sizeof(prefetch_candidates) / sizeof(prefetch_candidates[0]))
+#define PREFETCH_TUNE_MIN_PAIRS 5
+
+// One side of a paired prefetch trial: kernel at distance
+typedef struct {
+    const KernelInfo *kernel;
+    KernelArgs *args;
+    size_t distance;
+} PrefetchTrial;
+
+static void run_prefetch_trial(void *ctx) {
+    const PrefetchTrial *trial = ctx;
+    matrix_prefetch_distance = trial->distance;
+    trial->kernel->run(trial->args);
+}
+
+// Time kernel at every candidate prefetch distance in alternation with
+// distance 0, without the measurement hooks. A distance is only adopted
+// when the whole bootstrap interval of its speedup over 0 lies above 1;
+// of those, the one with the largest speedup wins. Otherwise 0 stays.
+static int tune_prefetch(const KernelInfo *kernel, KernelArgs *args, const BenchConfig *bench_cfg,
+                         CachePrep *prep, size_t *distance, FILE *console) {
+    BenchConfig tune_cfg = *bench_cfg;
+    PrefetchTrial off = { kernel, args, 0 };
+    size_t best = 0;
+    double best_speedup = 1.0;
+
+    tune_cfg.num_hooks = 0;
+    tune_cfg.single_shot = 0;
+    tune_cfg.warmup_iterations = 1;
+    tune_cfg.min_iterations = PREFETCH_TUNE_MIN_PAIRS;
+    if (tune_cfg.max_iterations < PREFETCH_TUNE_MIN_PAIRS) {
+        tune_cfg.max_iterations = PREFETCH_TUNE_MIN_PAIRS;
+    }
+    prep->args = args;
+
+    fprintf(console, "Tuning prefetch distance on %s...\n", kernel->name);
+    for (size_t d = 0; d < NUM_PREFETCH_CANDIDATES; d++) {
+        PrefetchTrial on = { kernel, args, prefetch_candidates[d] };
+        BenchResult result_off, result_on;
+        PairedResult paired;
+
+        if (on.distance == 0) continue;
+        if (bench_run_paired(&tune_cfg, run_prefetch_trial, &off, run_prefetch_trial, &on,
+                             &result_off, &result_on) != 0) {
+            prep->args = NULL;
+            return -1;
+        }
+        if (compare_paired_bootstrap(result_off.samples, result_on.samples, result_off.count,
+                                     COMPARE_BOOTSTRAP_RESAMPLES, &paired) == 0) {
+            int adopt = paired.ci_low > 1.0;
+            fprintf(console, "  distance %3zu: %.3fx vs off [%.3f, %.3f]%s\n", on.distance,
+                    paired.speedup, paired.ci_low, paired.ci_high,
+                    adopt ? "" : ", not significant");
+            if (adopt && paired.speedup > best_speedup) {
+                best = on.distance;
+                best_speedup = paired.speedup;
+            }
+        } else {
+            fprintf(console, "  distance %3zu: no confidence interval, skipped\n", on.distance);
+        }
+        bench_result_free(&result_off);
+        bench_result_free(&result_on);
+    }
+    prep->args = NULL;
+    *distance = best;
+    fprintf(console, "Prefetch distance for %s: %zu\n", kernel->name, best);
+    return 0;
+}
+
+// Measure the machine, choose the blocking and store both in the profile
+static int run_probe(const char *profile_path, FILE *console) {
+    UarchProfile profile;
+
+    fprintf(console, "=== Microarchitecture probe ===\n");
+    if (uarch_probe(&profile, console) != 0) {
+        fprintf(stderr, "Error: Probe failed (out of memory or no usable clock)\n");
+        return 1;
+    }
+    print_uarch_profile(console, &profile);
+    if (uarch_profile_save(&profile, profile_path) != 0) {
+        fprintf(stderr, "Error: Cannot write machine profile '%s'\n", profile_path);
+        return 1;
+    }
+    fprintf(console, "\nProfile written to %s\n", profile_path);
+    return 0;
+}
+
 void print_usage(const char *program_name) {
     printf("Usage: %s [options] [matrix_size]\n", program_name);
     printf("Options:\n");
     printf("  -h, --help     Show this help message\n");
     printf("  -v, --verify   Verify results (slower for large matrices)\n");
-    printf("  -t TILE_SIZE   Set tile size for cache-aware implementation\n");
+    printf("  -t TILE_SIZE   Set tile size for cache-aware implementation; 'auto' plans it\n");
+    printf("                 with the performance model (default: from the machine\n");
+    printf("                 profile, else %d)\n", DEFAULT_TILE_SIZE);
+    printf("  -k, --kernels LIST     Kernels to run, by name or glob (e.g. tiled*,vector);\n");
+    printf("                         'list' shows every kernel in this build\n");
+    printf("  -s, --single-shot      Time each kernel once without warmup\n");
+    printf("  -w, --warmup N         Untimed warmup runs per kernel (default: %d)\n", WARMUP_ITERATIONS);
+    printf("  -n, --iterations N     Minimum timed runs per kernel (default: %d)\n", BENCHMARK_ITERATIONS);
+    printf("  --max-iterations N     Maximum timed runs per kernel (default: %d)\n", BENCHMARK_MAX_ITERATIONS);
+    printf("  --target-ci PCT        Stop when the 95%% CI is within +/-PCT%% (default: %.1f)\n",
+           BENCHMARK_TARGET_REL_CI * 100.0);
+    printf("  --time-budget SEC      Sampling time budget per kernel (default: %.1f)\n", BENCHMARK_TIME_BUDGET);
+    printf("  --timer SOURCE         Time source: clock or cycles (default: clock)\n");
+    printf("  -f, --format FMT       Result format: table, csv or json (default: table)\n");
+    printf("  -o, --output FILE      Write csv/json results to FILE instead of stdout\n");
+    printf("  -j, --threads N        Threads for the parallel kernel (default: all processors)\n");
+    printf("  --prefetch N|auto      Software prefetch distance of the tiled and vector\n");
+    printf("                         kernels in k iterations, 0 off; 'auto' times candidates\n");
+    printf("                         against 0 on each selected kernel that prefetches\n");
+    printf("                         (default: %d)\n", PREFETCH_DISTANCE);
+    printf("  --cache MODE           warm: pre-touch A/B/C before each run; cold: flush\n");
+    printf("                         caches by streaming a buffer twice the LLC (default: warm)\n");
+    printf("  --prefault             Map matrices with every page faulted in up front\n");
+    printf("  --trace FILE           Write a Chrome/Perfetto trace of tile tasks to FILE\n");
+    printf("  --counters             Collect hardware performance counters per kernel\n");
+    printf("  --energy               Measure energy per kernel via RAPL or hwmon sensors\n");
+    printf("  --freq-monitor         Track CPU clock and temperature, flag unstable runs\n");
+    printf("  --freq-threshold PCT   Clock deviation that marks a run unstable (default: %.1f)\n",
+           FREQ_STABILITY_THRESHOLD * 100.0);
+    printf("  --discard-unstable     Exclude unstable runs from the summary statistics\n");
+    printf("  --phases               Break kernel time down by phase (needs PHASE_TIMING=1 build)\n");
+    printf("  --roofline[=FILE]      Measure peak FLOPS and bandwidth, place each kernel\n");
+    printf("                         on the roofline; FILE receives plot-ready CSV\n");
+    printf("  --sweep ITEM...        Run a parameter sweep in one process; items are\n");
+    printf("                         sizes=, tiles=, threads= and kernels= lists of values\n");
+    printf("                         or START:END:STEP ranges\n");
+    printf("  --scaling[=FILE]       Strong and weak scaling of the threaded kernel from 1\n");
+    printf("                         to -j threads; FILE receives plot-ready CSV\n");
+    printf("  --ab X,Y               Interleave kernels X and Y and report the speedup of Y\n");
+    printf("                         with a bootstrap 95%% confidence interval\n");
+    printf("  --probe                Measure FMA latency/throughput, cache sizes and line size,\n");
+    printf("                         choose the tile, save the machine profile\n");
+    printf("  --model [ITEM...]      Predict each configuration with the performance model and\n");
+    printf("                         report the error against measured runs; items as for\n");
+    printf("                         --sweep (default tiles: powers of two from 8 to 256)\n");
+    printf("  --profile FILE         Machine profile to read and write (default: %s)\n", UARCH_PROFILE_PATH);
+    printf("  --compare BASELINE     Re-run the configurations in a csv results file and\n");
+    printf("                         exit with status 2 if any of them regressed\n");
+    printf("  --alpha P              Significance level for --compare (default: %.2f)\n", COMPARE_DEFAULT_ALPHA);
+    printf("  --threshold PCT        Minimum median slowdown flagged by --compare (default: %.1f)\n",
+           COMPARE_DEFAULT_THRESHOLD * 100.0);
     printf("\nArguments:\n");
     printf("  matrix_size    Size of square matrices (default: %d)\n", DEFAULT_MATRIX_SIZE);
     printf("\nExamples:\n");
     printf("  %s 1024        # Test with 1024x1024 matrices\n", program_name);
     printf("  %s -v 512      # Test with verification enabled\n", program_name);
     printf("  %s -t 32 256   # Use tile size 32 for 256x256 matrices\n", program_name);
+    printf("  %s -n 20 --target-ci 1 256  # At least 20 runs, stop at +/-1%% CI\n", program_name);
+    printf("  %s --format=json 512 > results.json  # Machine-readable results\n", program_name);
+    printf("  %s --compare baseline.csv            # Regression check\n", program_name);
+    printf("  %s --energy 1024                     # GFLOPS per watt\n", program_name);
+    printf("  %s --sweep sizes=64:1024:64 tiles=16,32,64 kernels=tiled\n", program_name);
+}
+
+// Match "-x VALUE", "--name VALUE" or "--name=VALUE".
+// Returns 1 with *value set when matched, 0 when argv[*i] is another option,
+// and -1 when the option is present but its value is missing.
+static int option_value(int argc, char *argv[], int *i, const char *short_name,
+                        const char *long_name, const char **value) {
+    const char *arg = argv[*i];
+    size_t long_len = strlen(long_name);
+
+    if (strncmp(arg, long_name, long_len) == 0 && arg[long_len] == '=') {
+        *value = arg + long_len + 1;
+        return 1;
+    }
+    if (strcmp(arg, long_name) != 0 && (!short_name || strcmp(arg, short_name) != 0)) {
+        return 0;
+    }
+    if (*i + 1 >= argc) {
+        fprintf(stderr, "Error: %s option requires a value\n", arg);
+        return -1;
+    }
+    *value = argv[++(*i)];
+    return 1;
 }
 
 int main(int argc, char *argv[]) {
     size_t matrix_size = DEFAULT_MATRIX_SIZE;
     size_t tile_size = DEFAULT_TILE_SIZE;
     int verify_results = 0;
+    BenchConfig bench_cfg;
+    ReportFormat format = REPORT_TABLE;
+    const char *output_path = NULL;
+    const char *baseline_path = NULL;
+    CompareConfig compare_cfg;
+    int use_counters = 0;
+    int threads = get_num_processors();
+    const char *trace_path = NULL;
+    int use_energy = 0;
+    int use_freq = 0;
+    int discard_unstable = 0;
+    double freq_threshold = FREQ_STABILITY_THRESHOLD;
+    int use_phases = 0;
+    int use_roofline = 0;
+    const char *roofline_path = NULL;
+    TimerBackend timer_request = TIMER_CLOCK;
+    CachePrep cache_prep = { CACHE_WARM, { NULL, 0 }, NULL, NULL };
+    int prefault = 0;
+    const char *kernel_list = NULL;
+    SweepSpec sweep_spec;
+    int use_sweep = 0;
+    int use_scaling = 0;
+    const char *ab_pair = NULL;
+    const char *scaling_path = NULL;
+    int use_probe = 0;
+    int tile_given = 0;
+    int tile_auto = 0;
+    int prefetch_auto = 0;
+    const char *prefetch_source = "build default";
+    int use_model = 0;
+    const char *profile_path = UARCH_PROFILE_PATH;
+    const char *tile_source = "default";
+    const char *value;
+    int rc;
+    
+    bench_config_default(&bench_cfg);
+    compare_config_default(&compare_cfg);
+    sweep_spec_init(&sweep_spec);
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -38,8 +745,12 @@ int main(int argc, char *argv[]) {
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verify") == 0) {
             verify_results = 1;
         } else if (strcmp(argv[i], "-t") == 0) {
-            if (i + 1 < argc) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "auto") == 0) {
+                tile_auto = 1;
+                i++;
+            } else if (i + 1 < argc) {
                 tile_size = (size_t)atoi(argv[++i]);
+                tile_given = 1;
                 if (tile_size == 0) {
                     fprintf(stderr, "Error: Invalid tile size\n");
                     return 1;
@@ -48,6 +759,175 @@ int main(int argc, char *argv[]) {
                 fprintf(stderr, "Error: -t option requires a tile size\n");
                 return 1;
             }
+        } else if (strcmp(argv[i], "--roofline") == 0) {
+            use_roofline = 1;
+        } else if (strncmp(argv[i], "--roofline=", 11) == 0) {
+            use_roofline = 1;
+            roofline_path = argv[i] + 11;
+        } else if (strcmp(argv[i], "--scaling") == 0) {
+            use_scaling = 1;
+        } else if (strncmp(argv[i], "--scaling=", 10) == 0) {
+            use_scaling = 1;
+            scaling_path = argv[i] + 10;
+        } else if (strcmp(argv[i], "--freq-monitor") == 0) {
+            use_freq = 1;
+        } else if (strcmp(argv[i], "--discard-unstable") == 0) {
+            use_freq = 1;
+            discard_unstable = 1;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--freq-threshold", &value)) != 0) {
+            if (rc < 0) return 1;
+            freq_threshold = atof(value) / 100.0;
+            if (freq_threshold <= 0.0) {
+                fprintf(stderr, "Error: Frequency threshold must be positive\n");
+                return 1;
+            }
+            use_freq = 1;
+        } else if ((rc = option_value(argc, argv, &i, "-k", "--kernels", &value)) != 0) {
+            if (rc < 0) return 1;
+            if (strcmp(value, "list") == 0) {
+                print_kernel_list(stdout);
+                return 0;
+            }
+            kernel_list = value;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--ab", &value)) != 0) {
+            if (rc < 0) return 1;
+            ab_pair = value;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--cache", &value)) != 0) {
+            if (rc < 0) return 1;
+            if (cache_parse_mode(value, &cache_prep.mode) != 0) {
+                fprintf(stderr, "Error: Unknown cache mode '%s' (expected cold or warm)\n", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sweep") == 0 || strncmp(argv[i], "--sweep=", 8) == 0 ||
+                   strcmp(argv[i], "--model") == 0 || strncmp(argv[i], "--model=", 8) == 0) {
+            // Items may follow as separate arguments or as one quoted string
+            const char *option = argv[i][2] == 'm' ? "--model" : "--sweep";
+            use_sweep = 1;
+            use_model |= argv[i][2] == 'm';
+            if (argv[i][7] == '=' && sweep_parse(&sweep_spec, argv[i] + 8) != 0) {
+                fprintf(stderr, "Error: %s: %s\n", option, sweep_spec.error);
+                return 1;
+            }
+            while (i + 1 < argc && sweep_is_item(argv[i + 1])) {
+                if (sweep_parse(&sweep_spec, argv[++i]) != 0) {
+                    fprintf(stderr, "Error: %s: %s\n", option, sweep_spec.error);
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--probe") == 0) {
+            use_probe = 1;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--profile", &value)) != 0) {
+            if (rc < 0) return 1;
+            profile_path = value;
+        } else if (strcmp(argv[i], "--prefault") == 0) {
+            prefault = 1;
+        } else if (strcmp(argv[i], "--energy") == 0) {
+            use_energy = 1;
+        } else if (strcmp(argv[i], "--phases") == 0) {
+            use_phases = 1;
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            use_counters = 1;
+        } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--single-shot") == 0) {
+            bench_cfg.single_shot = 1;
+        } else if ((rc = option_value(argc, argv, &i, "-w", "--warmup", &value)) != 0) {
+            if (rc < 0) return 1;
+            bench_cfg.warmup_iterations = atoi(value);
+            if (bench_cfg.warmup_iterations < 0) {
+                fprintf(stderr, "Error: Invalid warmup count\n");
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, "-n", "--iterations", &value)) != 0) {
+            if (rc < 0) return 1;
+            bench_cfg.min_iterations = atoi(value);
+            if (bench_cfg.min_iterations <= 0) {
+                fprintf(stderr, "Error: Invalid iteration count\n");
+                return 1;
+            }
+            if (bench_cfg.max_iterations < bench_cfg.min_iterations) {
+                bench_cfg.max_iterations = bench_cfg.min_iterations;
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--max-iterations", &value)) != 0) {
+            if (rc < 0) return 1;
+            bench_cfg.max_iterations = atoi(value);
+            if (bench_cfg.max_iterations <= 0) {
+                fprintf(stderr, "Error: Invalid maximum iteration count\n");
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--target-ci", &value)) != 0) {
+            if (rc < 0) return 1;
+            bench_cfg.target_rel_ci = atof(value) / 100.0;
+            if (bench_cfg.target_rel_ci <= 0.0) {
+                fprintf(stderr, "Error: Invalid confidence interval target\n");
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--time-budget", &value)) != 0) {
+            if (rc < 0) return 1;
+            bench_cfg.time_budget_seconds = atof(value);
+            if (bench_cfg.time_budget_seconds <= 0.0) {
+                fprintf(stderr, "Error: Invalid time budget\n");
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, "-j", "--threads", &value)) != 0) {
+            if (rc < 0) return 1;
+            threads = atoi(value);
+            if (threads < 1 || threads > MAX_THREADS) {
+                fprintf(stderr, "Error: Thread count must be between 1 and %d\n", MAX_THREADS);
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--prefetch", &value)) != 0) {
+            if (rc < 0) return 1;
+            if (strcmp(value, "auto") == 0) {
+                prefetch_auto = 1;
+            } else {
+                char *end;
+                long dist = strtol(value, &end, 10);
+                if (end == value || *end != '\0' || dist < 0 || dist > PREFETCH_DISTANCE_MAX) {
+                    fprintf(stderr, "Error: Prefetch distance must be 0-%d or auto\n",
+                            PREFETCH_DISTANCE_MAX);
+                    return 1;
+                }
+                matrix_prefetch_distance = (size_t)dist;
+                prefetch_source = "--prefetch";
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--trace", &value)) != 0) {
+            if (rc < 0) return 1;
+            trace_path = value;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--timer", &value)) != 0) {
+            if (rc < 0) return 1;
+            if (strcmp(value, "clock") == 0) {
+                timer_request = TIMER_CLOCK;
+            } else if (strcmp(value, "cycles") == 0) {
+                timer_request = TIMER_CYCLES;
+            } else {
+                fprintf(stderr, "Error: Unknown timer '%s' (expected clock or cycles)\n", value);
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, "-f", "--format", &value)) != 0) {
+            if (rc < 0) return 1;
+            if (report_parse_format(value, &format) != 0) {
+                fprintf(stderr, "Error: Unknown output format '%s' (expected table, csv or json)\n", value);
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, "-o", "--output", &value)) != 0) {
+            if (rc < 0) return 1;
+            output_path = value;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--compare", &value)) != 0) {
+            if (rc < 0) return 1;
+            baseline_path = value;
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--alpha", &value)) != 0) {
+            if (rc < 0) return 1;
+            compare_cfg.alpha = atof(value);
+            if (compare_cfg.alpha <= 0.0 || compare_cfg.alpha >= 1.0) {
+                fprintf(stderr, "Error: Significance level must be between 0 and 1\n");
+                return 1;
+            }
+        } else if ((rc = option_value(argc, argv, &i, NULL, "--threshold", &value)) != 0) {
+            if (rc < 0) return 1;
+            compare_cfg.threshold = atof(value) / 100.0;
+            if (compare_cfg.threshold < 0.0) {
+                fprintf(stderr, "Error: Invalid regression threshold\n");
+                return 1;
+            }
         } else {
             // Assume it's the matrix size
             matrix_size = (size_t)atoi(argv[i]);
@@ -58,6 +938,180 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    // Other modes take a fixed distance; tuning needs the single-size run
+    if (prefetch_auto && (baseline_path || use_probe || use_sweep || ab_pair || use_scaling)) {
+        fprintf(stderr, "Error: --prefetch auto only tunes the benchmark run; give a distance\n");
+        return 1;
+    }
+    
+    // Counters, energy, frequency and phases are only collected by the
+    // single-size run, so other modes would drop them without a word
+    if ((use_counters || use_energy || use_freq || use_phases) &&
+        (baseline_path || use_probe || use_sweep || ab_pair || use_scaling)) {
+        fprintf(stderr, "Error: --counters, --energy, --freq-monitor and --phases only "
+                        "apply to the benchmark run\n");
+        return 1;
+    }
+    
+    // Human-readable progress moves to stderr when results go to stdout
+    FILE *console = stdout;
+    FILE *results_out = stdout;
+    if (format != REPORT_TABLE) {
+        if (output_path) {
+            results_out = fopen(output_path, "w");
+            if (!results_out) {
+                fprintf(stderr, "Error: Cannot open output file '%s'\n", output_path);
+                return 1;
+            }
+        } else {
+            console = stderr;
+        }
+    }
+    
+    // Cycle counters may be disabled for user mode; fall back to the clock
+    if (timer_init(timer_request) != timer_request) {
+        fprintf(console, "Warning: Cycle counter not readable, using the system clock\n");
+    }
+    
+    // Trace events are buffered per thread and written when the program exits
+    TraceSampleHook trace_hook;
+    if (trace_path) {
+        if (trace_start(trace_path) != 0) {
+            fprintf(stderr, "Error: Cannot start tracing\n");
+            return 1;
+        }
+        trace_sample_hook_init(&trace_hook);
+        bench_add_hook(&bench_cfg, &trace_hook.hook);
+    }
+    
+    // The flush buffer is sized and faulted in before any kernel runs
+    if (cache_prep.mode == CACHE_COLD && cache_flusher_init(&cache_prep.flusher, 0) != 0) {
+        fprintf(stderr, "Error: Failed to allocate cache flush buffer\n");
+        return 1;
+    }
+    bench_cfg.prepare = prepare_caches;
+    bench_cfg.prepare_user = &cache_prep;
+    Matrix* (*create)(size_t, size_t) = prefault ? matrix_create_prefaulted : matrix_create;
+    
+    // Regression gate mode replaces the single-size run
+    if (baseline_path) {
+        Report report;
+        report_begin(&report, format, results_out, &bench_cfg);
+        rc = run_compare(baseline_path, &compare_cfg, &bench_cfg, &cache_prep, create, &report,
+                         console);
+        report_end(&report);
+        if (results_out != stdout) {
+            fclose(results_out);
+        }
+        cache_flusher_free(&cache_prep.flusher);
+        return rc;
+    }
+    
+    // Probe mode measures the machine instead of running kernels
+    if (use_probe) {
+        cache_flusher_free(&cache_prep.flusher);
+        return run_probe(profile_path, console);
+    }
+    
+    // A profile probed on this CPU gives the tile without -t and the FMA
+    // chain count the register blocks are sized against
+    UarchProfile profile;
+    ModelMachine machine;
+    int have_machine = 0;
+    rc = uarch_profile_load(&profile, profile_path);
+    if (rc == 0) {
+        if (!tile_given && !tile_auto) {
+            tile_size = profile.tile_size;
+            tile_source = "machine profile";
+        }
+        matrix_fma_chains = profile.fma_chains;
+        have_machine = model_machine_from_profile(&machine, &profile) == 0;
+    } else if (rc > 0) {
+        fprintf(console, "Warning: %s was probed on '%s'; rerun --probe\n",
+                profile_path, profile.cpu_model);
+    }
+    
+    // -t auto plans the tile of the first modelled tiled kernel selected,
+    // from the ceilings stored in the profile
+    if (tile_auto) {
+        const KernelInfo *candidates[KERNEL_REGISTRY_MAX];
+        const KernelInfo *target = NULL;
+        char ignored[256];
+        size_t count = kernel_select(kernel_list, candidates, KERNEL_REGISTRY_MAX,
+                                     ignored, sizeof(ignored));
+        ModelPrediction prediction;
+
+        for (size_t k = 0; k < count && !target; k++) {
+            if ((candidates[k]->flags & KERNEL_USES_TILE) && candidates[k]->blocking) {
+                target = candidates[k];
+            }
+        }
+        if (!have_machine) {
+            fprintf(stderr, "Error: -t auto needs the ceilings in a machine profile; run --probe\n");
+            return 1;
+        }
+        if (!target) {
+            fprintf(stderr, "Error: -t auto needs a selected tiled kernel with a model\n");
+            return 1;
+        }
+        tile_size = model_plan_tile(&machine, target->blocking, matrix_size,
+                                    (target->flags & KERNEL_USES_THREADS) ? threads : 1,
+                                    &prediction);
+        tile_source = "planned by the model";
+    }
+    
+    // Sweep mode runs every configuration in this process
+    if (use_sweep) {
+        Report report;
+        ModelValidation validation;
+        if (use_model) {
+            if (!have_machine) {
+                fprintf(console, "Measuring machine ceilings (--probe stores them)...\n");
+                if (model_machine_measure(&machine, ROOFLINE_TEST_SECONDS) != 0) {
+                    fprintf(stderr, "Error: Failed to measure machine ceilings\n");
+                    return 1;
+                }
+            }
+            // Validation needs a spread of tiles to rank
+            if (sweep_spec.num_tiles == 0) {
+                for (size_t t = 8; t <= 256; t *= 2) {
+                    sweep_spec.tiles[sweep_spec.num_tiles++] = t;
+                }
+            }
+            model_validation_init(&validation, &machine);
+        }
+        sweep_spec_defaults(&sweep_spec, matrix_size, tile_size, threads);
+        if (sweep_spec.kernels[0] == '\0' && kernel_list) {
+            snprintf(sweep_spec.kernels, sizeof(sweep_spec.kernels), "%s", kernel_list);
+        }
+        report_begin(&report, format, results_out, &bench_cfg);
+        rc = run_sweep(&sweep_spec, &bench_cfg, &cache_prep, create, verify_results,
+                       use_model ? &validation : NULL, &report, console);
+        report_end(&report);
+        if (use_model) {
+            print_model_validation(console, &validation);
+            model_validation_free(&validation);
+        }
+        if (results_out != stdout) {
+            fclose(results_out);
+        }
+        cache_flusher_free(&cache_prep.flusher);
+        return rc;
+    }
+    
+    // Kernels to run, by name or glob
+    const KernelInfo *kernels[KERNEL_REGISTRY_MAX];
+    char unmatched[256];
+    size_t num_kernels = kernel_select(kernel_list, kernels, KERNEL_REGISTRY_MAX,
+                                       unmatched, sizeof(unmatched));
+    if (unmatched[0]) {
+        fprintf(console, "Warning: No kernel in this build matches '%s', skipped\n", unmatched);
+    }
+    if (num_kernels == 0) {
+        fprintf(stderr, "Error: No kernels selected (see --kernels=list)\n");
+        return 1;
+    }
+    
     // Validate parameters
     if (matrix_size < 2) {
         fprintf(stderr, "Error: Matrix size must be at least 2\n");
@@ -66,129 +1120,457 @@ int main(int argc, char *argv[]) {
     
     if (tile_size > matrix_size) {
         tile_size = matrix_size;
-        printf("Warning: Tile size adjusted to matrix size (%zu)\n", tile_size);
+        fprintf(console, "Warning: Tile size adjusted to matrix size (%zu)\n", tile_size);
     }
     
-    printf("=== RISC-V Matrix Multiplication Performance Test ===\n\n");
+    // A/B mode compares exactly two named kernels
+    if (ab_pair) {
+        char name_a[64];
+        size_t len = strcspn(ab_pair, ",");
+        const KernelInfo *kernel_a, *kernel_b;
+        Report report;
+
+        snprintf(name_a, sizeof(name_a), "%.*s", (int)len, ab_pair);
+        kernel_a = kernel_find(name_a);
+        kernel_b = ab_pair[len] == ',' ? kernel_find(ab_pair + len + 1) : NULL;
+        if (!kernel_a || !kernel_b) {
+            fprintf(stderr, "Error: --ab needs two kernel names from --kernels=list, e.g. tiled,vector\n");
+            return 1;
+        }
+        report_begin(&report, format, results_out, &bench_cfg);
+        rc = run_ab(kernel_a, kernel_b, matrix_size, tile_size, threads, &bench_cfg, &cache_prep,
+                    create, &report, console);
+        report_end(&report);
+        if (results_out != stdout) {
+            fclose(results_out);
+        }
+        cache_flusher_free(&cache_prep.flusher);
+        return rc;
+    }
+    
+    // Scaling mode runs the first selected threaded kernel
+    if (use_scaling) {
+        const KernelInfo *threaded = NULL;
+        for (size_t k = 0; k < num_kernels && !threaded; k++) {
+            if (kernels[k]->flags & KERNEL_USES_THREADS) threaded = kernels[k];
+        }
+        if (!threaded) {
+            fprintf(stderr, "Error: --scaling needs a kernel that takes a thread count\n");
+            return 1;
+        }
+        rc = run_scaling(threaded, matrix_size, tile_size, threads, &bench_cfg, &cache_prep,
+                         create, scaling_path, console);
+        cache_flusher_free(&cache_prep.flusher);
+        return rc;
+    }
+    
+    fprintf(console, "=== RISC-V Matrix Multiplication Performance Test ===\n\n");
     
     // Print system information
-    print_system_info();
+    if (console == stdout) {
+        print_system_info();
+    }
     
-    printf("Configuration:\n");
-    printf("  Matrix size: %zu x %zu\n", matrix_size, matrix_size);
-    printf("  Tile size: %zu\n", tile_size);
-    printf("  Verification: %s\n", verify_results ? "enabled" : "disabled");
+    fprintf(console, "Configuration:\n");
+    fprintf(console, "  Matrix size: %zu x %zu\n", matrix_size, matrix_size);
+    fprintf(console, "  Tile size: %zu (%s)\n", tile_size, tile_given ? "-t" : tile_source);
+    fprintf(console, "  Threads (parallel kernel): %d\n", threads);
+    fprintf(console, "  Kernels:");
+    for (size_t k = 0; k < num_kernels; k++) {
+        fprintf(console, "%s %s", k ? "," : "", kernels[k]->name);
+    }
+    fprintf(console, "\n");
+    fprintf(console, "  Verification: %s\n", verify_results ? "enabled" : "disabled");
+    fprintf(console, "  Zeroing C: %s\n", cache_zero_method());
+    if (prefetch_auto) {
+        fprintf(console, "  Prefetch distance: auto (tuned per kernel before the run)\n");
+    } else if (matrix_prefetch_distance == 0) {
+        fprintf(console, "  Prefetch distance: off (%s)\n", prefetch_source);
+    } else {
+        fprintf(console, "  Prefetch distance: %zu iterations (%s)\n", matrix_prefetch_distance,
+                prefetch_source);
+    }
     
 #ifdef USE_VECTOR
-    printf("  Vector instructions: enabled\n");
+    fprintf(console, "  Vector instructions: enabled\n");
+    if (matrix_fma_chains > 0) {
+        fprintf(console, "  RVV LMUL: %d for %zu x %zu (FMA chains: %d, machine profile)\n",
+                rvv_select_lmul(matrix_size, matrix_size), matrix_size, matrix_size,
+                matrix_fma_chains);
+    } else {
+        fprintf(console, "  RVV LMUL: %d for %zu x %zu (FMA chains unknown; run --probe)\n",
+                rvv_select_lmul(matrix_size, matrix_size), matrix_size, matrix_size);
+    }
 #else
-    printf("  Vector instructions: disabled\n");
+    fprintf(console, "  Vector instructions: disabled\n");
 #endif
     
-    printf("  Total operations: %.2f billion\n", 
+    if (bench_cfg.single_shot) {
+        fprintf(console, "  Timing: single shot\n");
+    } else {
+        fprintf(console, "  Timing: %d warmup, %d-%d iterations, target CI +/-%.1f%%, budget %.1fs\n",
+               bench_cfg.warmup_iterations, bench_cfg.min_iterations, bench_cfg.max_iterations,
+               bench_cfg.target_rel_ci * 100.0, bench_cfg.time_budget_seconds);
+    }
+    
+    if (cache_prep.mode == CACHE_COLD) {
+        fprintf(console, "  Cache: cold (%.1f MB flush buffer)%s\n",
+               (double)cache_prep.flusher.bytes / (1024.0 * 1024.0), prefault ? ", prefaulted" : "");
+    } else {
+        fprintf(console, "  Cache: warm%s\n", prefault ? ", prefaulted" : "");
+    }
+    
+    if (timer_backend() == TIMER_CYCLES) {
+        fprintf(console, "  Timer: %s (%.3f GHz, overhead %.1f ns)\n", timer_backend_name(),
+               timer_tick_frequency() / 1e9, timer_overhead_seconds() * 1e9);
+    } else {
+        fprintf(console, "  Timer: clock (overhead %.1f ns)\n", timer_overhead_seconds() * 1e9);
+    }
+    
+    // Energy sensors are optional; RAPL is usually root-only
+    EnergyMeter energy_meter;
+    EnergyRecorder energy_recorder;
+    double *kernel_energy[KERNEL_REGISTRY_MAX] = { NULL };
+    int energy_ok = 0;
+    
+    if (use_energy) {
+        energy_ok = energy_open(&energy_meter) == 0;
+        if (energy_ok) {
+            energy_recorder_init(&energy_recorder, &energy_meter);
+            bench_add_hook(&bench_cfg, &energy_recorder.hook);
+            fprintf(console, "  Energy: ");
+            print_energy_sources(console, &energy_meter);
+            fprintf(console, "\n");
+        } else {
+            fprintf(console, "  Energy: unavailable (%s)\n", energy_meter.error);
+        }
+    }
+    
+    // Clock and temperature during each sample, to catch throttling
+    FreqMonitor freq_monitor;
+    FreqRecorder freq_recorder;
+    FreqSample *kernel_freq[KERNEL_REGISTRY_MAX] = { NULL };
+    int freq_ok = 0;
+    
+    if (use_freq) {
+        freq_ok = freq_monitor_open(&freq_monitor, FREQ_SAMPLE_INTERVAL_MS) == 0;
+        if (freq_ok) {
+            freq_recorder_init(&freq_recorder, &freq_monitor);
+            bench_add_hook(&bench_cfg, &freq_recorder.hook);
+            fprintf(console, "  Frequency monitor: %d CPUs, %d thermal zones, threshold +/-%.1f%%%s\n",
+                   freq_monitor.num_cpus, freq_monitor.num_zones, freq_threshold * 100.0,
+                   discard_unstable ? ", unstable runs discarded" : "");
+        } else {
+            fprintf(console, "  Frequency monitor: unavailable (%s)\n", freq_monitor.error);
+        }
+    }
+    
+    // Hardware counters are optional; containers and emulators often lack them.
+    // They open after the frequency sampler starts, so only the kernels'
+    // worker threads inherit them.
+    PerfCounters counters;
+    PerfRecorder recorder;
+    PerfSample *kernel_counters[KERNEL_REGISTRY_MAX] = { NULL };
+    size_t kernel_counter_count[KERNEL_REGISTRY_MAX] = { 0 };
+    int counters_ok = 0;
+    
+    if (use_counters) {
+        counters_ok = perf_counters_open(&counters) == 0;
+        if (counters_ok) {
+            perf_recorder_init(&recorder, &counters);
+            bench_add_hook(&bench_cfg, &recorder.hook);
+            fprintf(console, "  Hardware counters: enabled\n");
+        } else {
+            fprintf(console, "  Hardware counters: unavailable (%s)\n", counters.error);
+        }
+    }
+    
+    // Phase regions only exist in instrumented builds
+    PhaseRecorder phase_recorder;
+    PhaseRecorder kernel_phases[KERNEL_REGISTRY_MAX];
+    
+    if (use_phases && !PHASE_TIMING_ENABLED) {
+        fprintf(console, "  Phase breakdown: unavailable (rebuild with make PHASE_TIMING=1)\n");
+        use_phases = 0;
+    } else if (use_phases) {
+        phase_recorder_init(&phase_recorder);
+        bench_add_hook(&bench_cfg, &phase_recorder.hook);
+        fprintf(console, "  Phase breakdown: enabled\n");
+    }
+    
+    if (trace_path) {
+        fprintf(console, "  Trace: %s (written at exit)\n", trace_path);
+    }
+    
+    fprintf(console, "  Total operations: %.2f billion\n", 
            (double)(2.0 * matrix_size * matrix_size * matrix_size) / 1e9);
-    printf("\n");
+    fprintf(console, "\n");
     
     // Allocate matrices
-    printf("Allocating matrices...\n");
-    Matrix *A = matrix_create(matrix_size, matrix_size);
-    Matrix *B = matrix_create(matrix_size, matrix_size);
-    Matrix *C_naive = matrix_create(matrix_size, matrix_size);
-    Matrix *C_tiled = matrix_create(matrix_size, matrix_size);
+    fprintf(console, "Allocating matrices...\n");
+    Matrix *A = create(matrix_size, matrix_size);
+    Matrix *B = create(matrix_size, matrix_size);
+    Matrix *Bt = any_transposed_b(kernels, num_kernels) ? create(matrix_size, matrix_size) : NULL;
+    Matrix *C[KERNEL_REGISTRY_MAX];
     
-    if (!A || !B || !C_naive || !C_tiled) {
+    if (!A || !B || (any_transposed_b(kernels, num_kernels) && !Bt)) {
         fprintf(stderr, "Error: Failed to allocate matrices\n");
         return 1;
     }
     
-#ifdef USE_VECTOR
-    Matrix *C_vector = matrix_create(matrix_size, matrix_size);
-    if (!C_vector) {
-        fprintf(stderr, "Error: Failed to allocate vector result matrix\n");
-        return 1;
+    for (size_t k = 0; k < num_kernels; k++) {
+        C[k] = create(matrix_size, matrix_size);
+        if (!C[k]) {
+            fprintf(stderr, "Error: Failed to allocate %s result matrix\n", kernels[k]->description);
+            return 1;
+        }
     }
-#endif
     
     // Initialize matrices with random data
-    printf("Initializing matrices with random data...\n");
+    fprintf(console, "Initializing matrices with random data...\n");
     seed_random(42); // Fixed seed for reproducible results
     matrix_init_random(A, -1.0, 1.0);
     matrix_init_random(B, -1.0, 1.0);
+    if (Bt) {
+        matrix_transpose(B, Bt);
+    }
+    
+    // --prefetch auto settles a distance for every selected kernel that
+    // prefetches, before any kernel is measured
+    size_t kernel_prefetch[KERNEL_REGISTRY_MAX];
+    int any_prefetch = 0;
+    for (size_t k = 0; k < num_kernels; k++) {
+        kernel_prefetch[k] = matrix_prefetch_distance;
+        if (!prefetch_auto || !(kernels[k]->flags & KERNEL_USES_PREFETCH)) continue;
+        
+        KernelArgs args = { A, B, C[k], tile_size, threads, transposed_operand(kernels[k], Bt) };
+        fprintf(console, "\n");
+        if (tune_prefetch(kernels[k], &args, &bench_cfg, &cache_prep, &kernel_prefetch[k],
+                          console) != 0) {
+            fprintf(stderr, "Error: Failed to record benchmark samples\n");
+            return 1;
+        }
+        any_prefetch = 1;
+    }
+    if (prefetch_auto && !any_prefetch) {
+        fprintf(console, "Warning: No selected kernel prefetches; distance left at %zu\n",
+                matrix_prefetch_distance);
+    }
+    
+    BenchResult results[KERNEL_REGISTRY_MAX];
+    
+    fprintf(console, "\nStarting performance tests...\n");
+    print_benchmark_header(console);
+    
+    Report report;
+    report_begin(&report, format, results_out, &bench_cfg);
+    
+    for (size_t k = 0; k < num_kernels; k++) {
+        KernelArgs args = { A, B, C[k], tile_size, threads, transposed_operand(kernels[k], Bt) };
+        
+        // C is left untouched so the first call pays its page faults
+        fprintf(console, "Running %s implementation...\n", kernels[k]->description);
+        cache_prep.args = &args;
+        matrix_prefetch_distance = kernel_prefetch[k];
+        if (counters_ok) {
+            perf_recorder_reset(&recorder);
+        }
+        if (energy_ok) {
+            energy_recorder_reset(&energy_recorder);
+        }
+        if (freq_ok) {
+            freq_recorder_reset(&freq_recorder);
+        }
+        if (use_phases) {
+            phase_recorder_reset(&phase_recorder);
+        }
+        trace_hook.name = kernels[k]->name;
+        if (bench_run(&bench_cfg, kernels[k]->run, &args, &results[k]) != 0) {
+            fprintf(stderr, "Error: Failed to record benchmark samples\n");
+            return 1;
+        }
+        
+        if (freq_ok && freq_recorder.count == results[k].count) {
+            kernel_freq[k] = malloc(freq_recorder.count * sizeof(FreqSample));
+            if (kernel_freq[k]) {
+                memcpy(kernel_freq[k], freq_recorder.samples, freq_recorder.count * sizeof(FreqSample));
+                size_t unstable = freq_mark_stable(kernel_freq[k], results[k].count, freq_threshold);
+                
+                // Raw samples stay in the results; only the statistics drop them
+                if (discard_unstable && unstable > 0 && results[k].count - unstable >= 2) {
+                    double *stable = malloc(results[k].count * sizeof(double));
+                    size_t kept = 0;
+                    if (stable) {
+                        for (size_t i = 0; i < results[k].count; i++) {
+                            if (kernel_freq[k][i].stable) stable[kept++] = results[k].samples[i];
+                        }
+                        bench_stats_compute(stable, kept, &results[k].stats);
+                        free(stable);
+                    }
+                }
+            }
+        }
+        print_benchmark_result(console, kernels[k]->name, matrix_size, &results[k]);
+        
+        if (use_phases) {
+            kernel_phases[k] = phase_recorder;
+        }
+        
+        if (energy_ok && energy_recorder.count == results[k].count) {
+            kernel_energy[k] = malloc(energy_recorder.count * sizeof(double));
+            if (kernel_energy[k]) {
+                memcpy(kernel_energy[k], energy_recorder.joules, energy_recorder.count * sizeof(double));
+            }
+        }
+        
+        if (counters_ok && recorder.count == results[k].count) {
+            kernel_counters[k] = malloc(recorder.count * sizeof(PerfSample));
+            if (kernel_counters[k]) {
+                memcpy(kernel_counters[k], recorder.samples, recorder.count * sizeof(PerfSample));
+                kernel_counter_count[k] = recorder.count;
+            }
+        }
+        
+        ReportRecord record = { kernels[k]->name, matrix_size,
+                                (kernels[k]->flags & KERNEL_USES_TILE) ? tile_size : 0,
+                                (kernels[k]->flags & KERNEL_USES_THREADS) ? threads : 1, kernel_counters[k],
+                                kernel_energy[k], kernel_freq[k] };
+        report_kernel(&report, &record, &results[k]);
+    }
     
-    printf("\nStarting performance tests...\n");
-    print_performance_header();
+    report_end(&report);
+    if (results_out != stdout) {
+        fclose(results_out);
+    }
     
-    Timer timer;
-    double time_ms, gflops;
+    if (!bench_cfg.single_shot) {
+        fprintf(console, "\nFirst call vs steady state (%s cache):\n", cache_mode_name(cache_prep.mode));
+        print_first_call_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            print_first_call_result(console, kernels[k]->name, matrix_size, &results[k]);
+        }
+    }
     
-    // Test 1: Naive implementation
-    printf("Running naive implementation...\n");
-    matrix_init_zero(C_naive);
-    timer_start(&timer);
-    matrix_mult_naive(A, B, C_naive);
-    timer_stop(&timer);
+    if (counters_ok) {
+        fprintf(console, "\nHardware counters (mean per call):\n");
+        print_counters_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            print_counters_result(console, kernels[k]->name, matrix_size,
+                                  kernel_counters[k], kernel_counter_count[k]);
+        }
+        perf_recorder_free(&recorder);
+        perf_counters_close(&counters);
+    }
     
-    time_ms = timer_elapsed_ms(&timer);
-    gflops = calculate_gflops(matrix_size, timer_elapsed_seconds(&timer));
-    print_performance_result("Naive", matrix_size, time_ms, gflops);
+    if (freq_ok) {
+        fprintf(console, "\nFrequency stability:\n");
+        print_stability_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            print_stability_result(console, kernels[k]->name, matrix_size, kernel_freq[k], &results[k]);
+        }
+        freq_recorder_free(&freq_recorder);
+        freq_monitor_close(&freq_monitor);
+    }
     
-    // Test 2: Cache-aware tiled implementation
-    printf("Running cache-aware tiled implementation...\n");
-    matrix_init_zero(C_tiled);
-    timer_start(&timer);
-    matrix_mult_tiled(A, B, C_tiled, tile_size);
-    timer_stop(&timer);
+    if (energy_ok) {
+        fprintf(console, "\nEnergy (mean per call):\n");
+        print_energy_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            print_energy_result(console, kernels[k]->name, matrix_size, kernel_energy[k], &results[k]);
+        }
+        energy_recorder_free(&energy_recorder);
+    }
     
-    time_ms = timer_elapsed_ms(&timer);
-    gflops = calculate_gflops(matrix_size, timer_elapsed_seconds(&timer));
-    print_performance_result("Tiled", matrix_size, time_ms, gflops);
+    if (use_phases) {
+        fprintf(console, "\nPhase breakdown (mean per call):\n");
+        print_phase_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            print_phase_breakdown(console, kernels[k]->name, &kernel_phases[k]);
+        }
+    }
     
-#ifdef USE_VECTOR
-    // Test 3: Vector implementation
-    printf("Running vector implementation...\n");
-    matrix_init_zero(C_vector);
-    timer_start(&timer);
-    matrix_mult_vector(A, B, C_vector);
-    timer_stop(&timer);
-    
-    time_ms = timer_elapsed_ms(&timer);
-    gflops = calculate_gflops(matrix_size, timer_elapsed_seconds(&timer));
-    print_performance_result("Vector", matrix_size, time_ms, gflops);
-#endif
+    // Place each kernel against ceilings measured on this machine
+    if (use_roofline) {
+        RoofMachine machine;
+        RoofPoint points[KERNEL_REGISTRY_MAX];
+        
+        fprintf(console, "\nMeasuring roofline ceilings...\n");
+        if (roofline_measure(&machine, ROOFLINE_TEST_SECONDS) != 0) {
+            fprintf(stderr, "Error: Failed to allocate roofline test buffers\n");
+            return 1;
+        }
+        print_roofline_machine(console, &machine);
+        print_roofline_header(console);
+        for (size_t k = 0; k < num_kernels; k++) {
+            roofline_point(&machine, kernels[k]->name, matrix_size,
+                           (kernels[k]->flags & KERNEL_USES_TILE) ? tile_size : 0, kernels[k]->traffic,
+                           results[k].stats.median, &points[k]);
+            print_roofline_point(console, &points[k]);
+        }
+        
+        if (roofline_path) {
+            FILE *f = fopen(roofline_path, "w");
+            if (!f) {
+                fprintf(stderr, "Error: Cannot open roofline output '%s'\n", roofline_path);
+                return 1;
+            }
+            write_roofline_csv(f, &machine, points, num_kernels);
+            fclose(f);
+            fprintf(console, "Roofline data written to %s\n", roofline_path);
+        }
+    }
     
     // Verification
     if (verify_results) {
-        printf("\nVerifying results...\n");
+        fprintf(console, "\nVerifying results...\n");
         
-        if (matrix_verify(C_naive, C_tiled, VERIFICATION_TOLERANCE)) {
-            printf("✓ Naive and tiled results match\n");
-        } else {
-            printf("✗ Naive and tiled results differ!\n");
+        for (size_t k = 1; k < num_kernels; k++) {
+            if (matrix_verify(C[0], C[k], VERIFICATION_TOLERANCE)) {
+                fprintf(console, "✓ %s and %s results match\n", kernels[0]->name, kernels[k]->name);
+            } else {
+                fprintf(console, "✗ %s and %s results differ!\n", kernels[0]->name, kernels[k]->name);
+            }
         }
         
-#ifdef USE_VECTOR
-        if (matrix_verify(C_naive, C_vector, VERIFICATION_TOLERANCE)) {
-            printf("✓ Naive and vector results match\n");
-        } else {
-            printf("✗ Naive and vector results differ!\n");
+        // Inputs come from a fixed-seed generator, so these compare across
+        // builds, e.g. an emulated RVV kernel against the same one in qemu
+        fprintf(console, "\nResult checksums (bitwise):\n");
+        for (size_t k = 0; k < num_kernels; k++) {
+            fprintf(console, "  %-10s %016llx\n", kernels[k]->name, matrix_checksum(C[k]));
         }
-#endif
     }
     
-    // Calculate speedups
-    printf("\nPerformance Summary:\n");
-    // Additional analysis would go here
+    // Calculate speedups (median times, relative to the first kernel)
+    fprintf(console, "\nPerformance Summary:\n");
+    double fmas = (double)matrix_size * matrix_size * matrix_size;
+    for (size_t k = 0; k < num_kernels; k++) {
+        const BenchStats *s = &results[k].stats;
+        fprintf(console, "  %-10s median %.3f ms, speedup vs %s: %.2fx",
+               kernels[k]->name, s->median * 1000.0, kernels[0]->name,
+               results[0].stats.median / s->median);
+        if (timer_backend() == TIMER_CYCLES) {
+            fprintf(console, ", %.3f %s/FMA", s->median * timer_tick_frequency() / fmas,
+                   timer_counts_core_cycles() ? "cycles" : "ref-cycles");
+        }
+        if (!bench_cfg.single_shot && s->rel_ci95 > bench_cfg.target_rel_ci) {
+            fprintf(console, "  (CI +/-%.1f%% above target)", s->rel_ci95 * 100.0);
+        }
+        fprintf(console, "\n");
+    }
     
     // Cleanup
+    for (size_t k = 0; k < num_kernels; k++) {
+        bench_result_free(&results[k]);
+        free(kernel_counters[k]);
+        free(kernel_energy[k]);
+        free(kernel_freq[k]);
+        matrix_destroy(C[k]);
+    }
     matrix_destroy(A);
     matrix_destroy(B);
-    matrix_destroy(C_naive);
-    matrix_destroy(C_tiled);
-    
-#ifdef USE_VECTOR
-    matrix_destroy(C_vector);
-#endif
+    matrix_destroy(Bt);
+    cache_flusher_free(&cache_prep.flusher);
     
-    printf("\nTest completed successfully!\n");
+    fprintf(console, "\nTest completed successfully!\n");
     return 0;
 }
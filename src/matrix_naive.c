@@ -1,9 +1,17 @@
 #include "matrix.h"
 #include "utils.h"
+#include "phase_timing.h"
+#include "probes.h"
+#include "kernel_registry.h"
+#include "cache_control.h"
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+size_t matrix_prefetch_distance = PREFETCH_DISTANCE;
+int matrix_fma_chains = 0;
+
 // Matrix allocation and initialization
 Matrix* matrix_create(size_t rows, size_t cols) {
     Matrix *mat = malloc(sizeof(Matrix));
@@ -18,12 +26,32 @@ Matrix* matrix_create(size_t rows, size_t cols) {
     
     mat->rows = rows;
     mat->cols = cols;
+    mat->prefaulted = 0;
+    return mat;
+}
+
+// Same as matrix_create, but every page is mapped before the first access
+Matrix* matrix_create_prefaulted(size_t rows, size_t cols) {
+    Matrix *mat = malloc(sizeof(Matrix));
+    if (!mat) return NULL;
+    
+    mat->data = (double*)prefaulted_malloc(rows * cols * sizeof(double));
+    if (!mat->data) {
+        free(mat);
+        return NULL;
+    }
+    
+    mat->rows = rows;
+    mat->cols = cols;
+    mat->prefaulted = 1;
     return mat;
 }
 
 void matrix_destroy(Matrix *mat) {
     if (mat) {
-        if (mat->data) {
+        if (mat->data && mat->prefaulted) {
+            prefaulted_free(mat->data, mat->rows * mat->cols * sizeof(double));
+        } else if (mat->data) {
             aligned_free(mat->data);
         }
         free(mat);
@@ -40,7 +68,7 @@ void matrix_init_random(Matrix *mat, double min, double max) {
 
 void matrix_init_zero(Matrix *mat) {
     if (!mat || !mat->data) return;
-    memset(mat->data, 0, mat->rows * mat->cols * sizeof(double));
+    cache_zero(mat->data, mat->rows * mat->cols * sizeof(double));
 }
 
 // Naive matrix multiplication implementation
@@ -55,9 +83,11 @@ void matrix_mult_naive(const Matrix *A, const Matrix *B, Matrix *C) {
     size_t n = A->rows;
     size_t m = A->cols;
     size_t p = B->cols;
+    PROBE_KERNEL_ENTRY("naive", n, m, p);
     
     // Simple triple-nested loop implementation
     // This is the most basic approach with poor cache locality
+    PHASE_BEGIN(kernel_mark);
     for (size_t i = 0; i < n; i++) {
         for (size_t j = 0; j < p; j++) {
             double sum = 0.0;
@@ -67,6 +97,8 @@ void matrix_mult_naive(const Matrix *A, const Matrix *B, Matrix *C) {
             MATRIX_SET(C, i, j, sum);
         }
     }
+    PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, p, m));
+    PROBE_KERNEL_EXIT("naive", n, m, p);
 }
 
 // Matrix verification function
@@ -83,3 +115,41 @@ int matrix_verify(const Matrix *A, const Matrix *B, double tolerance) {
     
     return 1; // Matrices match within tolerance
 }
+
+void matrix_transpose(const Matrix *src, Matrix *dst) {
+    if (!src || !dst || dst->rows != src->cols || dst->cols != src->rows) return;
+    
+    for (size_t i = 0; i < src->rows; i++) {
+        for (size_t j = 0; j < src->cols; j++) {
+            MATRIX_SET(dst, j, i, MATRIX_GET(src, i, j));
+        }
+    }
+}
+
+unsigned long long matrix_checksum(const Matrix *mat) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    const unsigned char *bytes = (const unsigned char *)mat->data;
+    
+    for (size_t i = 0; i < mat->rows * mat->cols * sizeof(double); i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Registration
+static void run_naive(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_naive(args->A, args->B, args->C);
+}
+
+// ijk with the dot product in a register: one unblocked pass
+static void blocking_naive(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)tile;
+    (void)threads;
+    *out = (ModelBlocking){ n, n, n, 1, 1, n, 1 };
+}
+
+REGISTER_KERNEL(naive,
+    .name = "Naive", .description = "naive", .run = run_naive, .isa = "scalar",
+    .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT,
+    .traffic = roofline_traffic_naive, .blocking = blocking_naive, .order = 0)
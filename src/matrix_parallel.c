@@ -0,0 +1,144 @@
+#include "matrix.h"
+#include "utils.h"
+#include "config.h"
+#include "phase_timing.h"
+#include "trace.h"
+#include "probes.h"
+#include "kernel_registry.h"
+#include "cache_control.h"
+#include <pthread.h>
+
+// Work shared by the threads of one matrix_mult_tiled_parallel call.
+// Row panels of tile_size rows are handed out dynamically so that a slow
+// thread does not hold up a fixed share of the work.
+typedef struct {
+    const Matrix *A;
+    const Matrix *B;
+    Matrix *C;
+    size_t tile_size;
+    size_t num_panels;
+    size_t next_panel;      // Claimed with an atomic fetch-add
+} ParallelWork;
+
+typedef struct {
+    ParallelWork *work;
+    int tid;
+} ParallelWorker;
+
+// Compute rows [ii, i_end) of C with ikj-ordered tiles
+static void compute_panel(const ParallelWork *work, size_t ii, size_t i_end) {
+    const Matrix *A = work->A;
+    const Matrix *B = work->B;
+    Matrix *C = work->C;
+    size_t m = A->cols;
+    size_t p = B->cols;
+    size_t tile_size = work->tile_size;
+
+    // Each thread clears only the rows it owns
+    PHASE_BEGIN(zero_mark);
+    cache_zero(&MATRIX_GET(C, ii, 0), (i_end - ii) * p * sizeof(double));
+    PHASE_END(zero_mark, PHASE_ZERO, (i_end - ii) * p * sizeof(double));
+
+    for (size_t kk = 0; kk < m; kk += tile_size) {
+        for (size_t jj = 0; jj < p; jj += tile_size) {
+            size_t k_end = (kk + tile_size < m) ? kk + tile_size : m;
+            size_t j_end = (jj + tile_size < p) ? jj + tile_size : p;
+
+            PROBE_TILE_START(ii, jj, kk);
+            PHASE_BEGIN(tile_mark);
+            for (size_t i = ii; i < i_end; i++) {
+                for (size_t k = kk; k < k_end; k++) {
+                    double a_ik = MATRIX_GET(A, i, k);
+                    for (size_t j = jj; j < j_end; j++) {
+                        MATRIX_SET(C, i, j, MATRIX_GET(C, i, j) + a_ik * MATRIX_GET(B, k, j));
+                    }
+                }
+            }
+            PHASE_END(tile_mark, PHASE_MICRO_KERNEL,
+                      TILE_FOOTPRINT_BYTES(i_end - ii, j_end - jj, k_end - kk));
+            PROBE_TILE_END(ii, jj, kk);
+        }
+    }
+}
+
+static void* parallel_worker(void *arg) {
+    ParallelWorker *worker = arg;
+    ParallelWork *work = worker->work;
+    size_t n = work->A->rows;
+
+    trace_set_thread(worker->tid);
+    for (;;) {
+        size_t panel = __atomic_fetch_add(&work->next_panel, 1, __ATOMIC_RELAXED);
+        if (panel >= work->num_panels) break;
+
+        size_t ii = panel * work->tile_size;
+        size_t i_end = (ii + work->tile_size < n) ? ii + work->tile_size : n;
+
+        TRACE_BEGIN(task_mark);
+        compute_panel(work, ii, i_end);
+        TRACE_END(task_mark, "row_panel", "task", (long)panel);
+    }
+    return NULL;
+}
+
+// Multithreaded cache-aware multiplication. The calling thread works as
+// thread 0; num_threads <= 1 runs everything on the calling thread.
+void matrix_mult_tiled_parallel(const Matrix *A, const Matrix *B, Matrix *C,
+                                size_t tile_size, int num_threads) {
+    if (!A || !B || !C || !A->data || !B->data || !C->data) return;
+
+    // Verify dimensions
+    if (A->cols != B->rows || A->rows != C->rows || B->cols != C->cols) {
+        return; // Invalid dimensions
+    }
+    if (tile_size == 0) return;
+    PROBE_KERNEL_ENTRY("parallel", A->rows, A->cols, B->cols);
+
+    ParallelWork work = { A, B, C, tile_size, (A->rows + tile_size - 1) / tile_size, 0 };
+    ParallelWorker workers[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    int started = 0;
+
+    if (num_threads < 1) num_threads = 1;
+    if (num_threads > MAX_THREADS) num_threads = MAX_THREADS;
+    if ((size_t)num_threads > work.num_panels) num_threads = (int)work.num_panels;
+
+    for (int t = 1; t < num_threads; t++) {
+        workers[t].work = &work;
+        workers[t].tid = t;
+        if (pthread_create(&threads[t], NULL, parallel_worker, &workers[t]) != 0) {
+            break;  // Remaining panels are picked up by the threads that did start
+        }
+        started = t;
+    }
+
+    workers[0].work = &work;
+    workers[0].tid = 0;
+    parallel_worker(&workers[0]);
+
+    // Time the calling thread spends waiting for stragglers
+    PHASE_BEGIN(sync_mark);
+    for (int t = 1; t <= started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    PHASE_END(sync_mark, PHASE_SYNC, 0);
+    PROBE_KERNEL_EXIT("parallel", A->rows, A->cols, B->cols);
+}
+
+// Registration
+static void run_parallel(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_tiled_parallel(args->A, args->B, args->C, args->tile_size, args->threads);
+}
+
+// Row panels of one tile per thread, ikj within each tile
+static void blocking_parallel(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)n;
+    *out = (ModelBlocking){ tile, tile, tile, 1, tile, 1, threads };
+}
+
+REGISTER_KERNEL(parallel,
+    .name = "Parallel", .description = "multithreaded tiled", .run = run_parallel,
+    .isa = "scalar", .flags = KERNEL_USES_TILE | KERNEL_USES_THREADS,
+    .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT,
+    .traffic = roofline_traffic_tiled, .blocking = blocking_parallel, .order = 20)
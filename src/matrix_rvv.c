@@ -0,0 +1,437 @@
+#include "matrix.h"
+#include "utils.h"
+#include "phase_timing.h"
+#include "probes.h"
+#include "kernel_registry.h"
+#include "config.h"
+#include "rvv_emul.h"
+
+#ifdef USE_VECTOR
+
+// RVV intrinsics: native with the V extension, emulated at RVV_EMUL_VLEN
+// elsewhere. Each C[i][j] accumulates its k terms in order with fused
+// multiply-adds whatever the VLEN, so results match across builds.
+void matrix_mult_rvv(const Matrix *A, const Matrix *B, Matrix *C) {
+    if (!A || !B || !C || !A->data || !B->data || !C->data) return;
+
+    // Verify dimensions
+    if (A->cols != B->rows || A->rows != C->rows || B->cols != C->cols) {
+        return; // Invalid dimensions
+    }
+
+    size_t n = A->rows;
+    size_t m = A->cols;
+    size_t p = B->cols;
+    PROBE_KERNEL_ENTRY("rvv", n, m, p);
+
+    PHASE_BEGIN(zero_mark);
+    matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
+
+    // Local pointers: stores through C could otherwise alias the Matrix
+    // fields and force reloads every step
+    const double *a = A->data;
+    const double *b = B->data;
+    double *c = C->data;
+
+    PHASE_BEGIN(kernel_mark);
+    for (size_t i = 0; i < n; i++) {
+        double *c_row = c + i * p;
+        for (size_t k = 0; k < m; k++) {
+            double a_ik = a[i * m + k];
+            const double *b_row = b + k * p;
+
+            for (size_t j = 0, vl; j < p; j += vl) {
+                vl = __riscv_vsetvl_e64m1(p - j);
+                vfloat64m1_t vb = __riscv_vle64_v_f64m1(b_row + j, vl);
+                vfloat64m1_t vc = __riscv_vle64_v_f64m1(c_row + j, vl);
+                vc = __riscv_vfmacc_vf_f64m1(vc, a_ik, vb, vl);
+                __riscv_vse64_v_f64m1(c_row + j, vc, vl);
+            }
+        }
+    }
+    PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, p, m));
+    PROBE_KERNEL_EXIT("rvv", n, m, p);
+}
+
+// Register-blocked micro-kernels, one per LMUL. Each keeps an MR x VL block
+// of C in MR register groups for the whole k loop: per step one vector
+// load of B and MR vfmacc.vf with scalars from A. Rows per LMUL fill the
+// 32 vector registers with accumulators plus the B group (29, 26, 28 and
+// 32 registers); m1 stops at 28 rows to leave v0 and one spare register
+// for the next B load. Sizeless RVV types cannot form arrays, hence the unrolled
+// named accumulators.
+#define RVV_REP1(X, l)  X(l, 0)
+#define RVV_REP3(X, l)  X(l, 0) X(l, 1) X(l, 2)
+#define RVV_REP6(X, l)  RVV_REP3(X, l) X(l, 3) X(l, 4) X(l, 5)
+#define RVV_REP12(X, l) RVV_REP6(X, l) X(l, 6) X(l, 7) X(l, 8) X(l, 9) X(l, 10) X(l, 11)
+#define RVV_REP16(X, l) RVV_REP12(X, l) X(l, 12) X(l, 13) X(l, 14) X(l, 15)
+#define RVV_REP28(X, l) RVV_REP16(X, l) X(l, 16) X(l, 17) X(l, 18) X(l, 19) X(l, 20) \
+                        X(l, 21) X(l, 22) X(l, 23) X(l, 24) X(l, 25) X(l, 26) X(l, 27)
+
+#define RVV_ACC_ZERO(lmul, r)  vfloat64##lmul##_t c##r = __riscv_vfmv_v_f_f64##lmul(0.0, vl);
+#define RVV_ACC_FMA(lmul, r)   c##r = __riscv_vfmacc_vf_f64##lmul(c##r, a[(r) * lda + k], vb, vl);
+#define RVV_ACC_STORE(lmul, r) __riscv_vse64_v_f64##lmul(c + (r) * ldc, c##r, vl);
+#define RVV_PREFETCH_A(lmul, r) PREFETCH(a + (r) * lda + k + dist);
+
+// C[0, mr)[0, vl) = A[0, mr)[0, depth) * B[0, depth)[0, vl). Starting the
+// accumulators at zero adds the same terms in the same order as the
+// unblocked kernel, so results stay bit-identical. The k with a B row
+// matrix_prefetch_distance steps ahead prefetch it and, once per line, the
+// A columns; the k loop is split at pf_end so neither part tests per step.
+#define DEFINE_RVV_MICRO(lmul, mr)                                                      \
+    static void rvv_micro_##lmul##_##mr(size_t depth, const double *a, size_t lda,      \
+                                        const double *b, size_t ldb, double *c,         \
+                                        size_t ldc, size_t vl) {                        \
+        size_t dist = matrix_prefetch_distance;                                         \
+        size_t pf_end = PREFETCH_END(dist, depth);                                      \
+        size_t k = 0;                                                                   \
+        RVV_REP##mr(RVV_ACC_ZERO, lmul)                                                 \
+        while (k < pf_end) {                                                            \
+            size_t line_end = k + PREFETCH_LINE_DOUBLES < pf_end ?                      \
+                              k + PREFETCH_LINE_DOUBLES : pf_end;                       \
+            RVV_REP##mr(RVV_PREFETCH_A, lmul)                                           \
+            for (; k < line_end; k++) {                                                 \
+                for (size_t j = 0; j < vl; j += PREFETCH_LINE_DOUBLES) {                \
+                    PREFETCH(b + (k + dist) * ldb + j);                                 \
+                }                                                                       \
+                vfloat64##lmul##_t vb = __riscv_vle64_v_f64##lmul(b + k * ldb, vl);     \
+                RVV_REP##mr(RVV_ACC_FMA, lmul)                                          \
+            }                                                                           \
+        }                                                                               \
+        for (; k < depth; k++) {                                                        \
+            vfloat64##lmul##_t vb = __riscv_vle64_v_f64##lmul(b + k * ldb, vl);         \
+            RVV_REP##mr(RVV_ACC_FMA, lmul)                                              \
+        }                                                                               \
+        RVV_REP##mr(RVV_ACC_STORE, lmul)                                                \
+    }
+
+// The vsetvl intrinsics are builtins, so the shape table calls wrappers
+#define DEFINE_RVV_SETVL(lmul)                                                          \
+    static size_t rvv_setvl_##lmul(size_t avl) {                                        \
+        return __riscv_vsetvl_e64##lmul(avl);                                           \
+    }
+
+DEFINE_RVV_MICRO(m1, 28)
+DEFINE_RVV_MICRO(m1, 1)
+DEFINE_RVV_MICRO(m2, 12)
+DEFINE_RVV_MICRO(m2, 1)
+DEFINE_RVV_MICRO(m4, 6)
+DEFINE_RVV_MICRO(m4, 1)
+DEFINE_RVV_MICRO(m8, 3)
+DEFINE_RVV_MICRO(m8, 1)
+
+DEFINE_RVV_SETVL(m1)
+DEFINE_RVV_SETVL(m2)
+DEFINE_RVV_SETVL(m4)
+DEFINE_RVV_SETVL(m8)
+
+typedef void (*rvv_micro_fn)(size_t depth, const double *a, size_t lda, const double *b,
+                             size_t ldb, double *c, size_t ldc, size_t vl);
+
+typedef struct {
+    int lmul;
+    size_t mr;              // Rows of the register block
+    rvv_micro_fn block;     // mr rows
+    rvv_micro_fn row;       // One row, for the rows left over
+    size_t (*setvl)(size_t avl);
+} RvvShape;
+
+static const RvvShape rvv_shapes[] = {
+    { 1, 28, rvv_micro_m1_28, rvv_micro_m1_1, rvv_setvl_m1 },
+    { 2, 12, rvv_micro_m2_12, rvv_micro_m2_1, rvv_setvl_m2 },
+    { 4,  6, rvv_micro_m4_6,  rvv_micro_m4_1, rvv_setvl_m4 },
+    { 8,  3, rvv_micro_m8_3,  rvv_micro_m8_1, rvv_setvl_m8 },
+};
+
+#define RVV_NUM_SHAPES (sizeof(rvv_shapes) / sizeof(rvv_shapes[0]))
+
+static const RvvShape* rvv_shape(int lmul) {
+    for (size_t s = 0; s < RVV_NUM_SHAPES; s++) {
+        if (rvv_shapes[s].lmul == lmul) return &rvv_shapes[s];
+    }
+    return NULL;
+}
+
+// Slots per k step of a block with fmas independent register FMAs: one
+// each, but no fewer than the probed chain count, as the next step's FMAs
+// wait on these for the FMA latency
+static double rvv_fma_slots(size_t fmas) {
+    return (double)(fmas < (size_t)matrix_fma_chains ? (size_t)matrix_fma_chains : fmas);
+}
+
+// Cost per k step of covering rows x cols: every column strip runs its
+// row blocks (mr scalar loads, a B load of LMUL registers and mr vfmacc
+// of LMUL registers each) and leftover single rows. Strips cost the same
+// however short, so wide groups lose on narrow matrices, while small
+// blocks reload B more often and, below matrix_fma_chains, stall on FMA
+// latency.
+int rvv_select_lmul(size_t rows, size_t cols) {
+    size_t vlmax_m1 = __riscv_vlenb() / sizeof(double);
+    const RvvShape *best = &rvv_shapes[0];
+    double best_cost = 0.0;
+
+    for (size_t s = 0; s < RVV_NUM_SHAPES; s++) {
+        const RvvShape *shape = &rvv_shapes[s];
+        size_t vl = vlmax_m1 * shape->lmul;
+        double strips = (double)((cols + vl - 1) / vl);
+        double blocks = (double)(rows / shape->mr);
+        double rest = (double)(rows % shape->mr);
+        double block_cost = shape->mr + shape->lmul + rvv_fma_slots(shape->mr * shape->lmul);
+        double row_cost = 1 + shape->lmul + rvv_fma_slots(shape->lmul);
+        double cost = strips * (blocks * block_cost + rest * row_cost);
+
+        if (s == 0 || cost < best_cost) {
+            best = shape;
+            best_cost = cost;
+        }
+    }
+    return best->lmul;
+}
+
+// A and C lines of the rows [first, end) of the next row block, for reading
+// and for writing (Zicbop prefetch.r and prefetch.w on RISC-V)
+static void rvv_prefetch_rows(const double *a, size_t lda, double *c, size_t ldc, size_t first,
+                              size_t end) {
+    for (size_t r = first; r < end; r++) {
+        PREFETCH(a + r * lda);
+        PREFETCH_W(c + r * ldc);
+    }
+}
+
+// Column strips of one register group, each swept by MR-row blocks over
+// the full depth; lmul 0 selects it with rvv_select_lmul
+void matrix_mult_rvv_lmul(const Matrix *A, const Matrix *B, Matrix *C, int lmul) {
+    if (!A || !B || !C || !A->data || !B->data || !C->data) return;
+
+    // Verify dimensions
+    if (A->cols != B->rows || A->rows != C->rows || B->cols != C->cols) {
+        return; // Invalid dimensions
+    }
+
+    size_t n = A->rows;
+    size_t m = A->cols;
+    size_t p = B->cols;
+    const RvvShape *shape = rvv_shape(lmul ? lmul : rvv_select_lmul(n, p));
+    if (!shape) return;
+    PROBE_KERNEL_ENTRY("rvv_lmul", n, m, p);
+
+    const double *a = A->data;
+    const double *b = B->data;
+    double *c = C->data;
+
+    PHASE_BEGIN(kernel_mark);
+    for (size_t j = 0, vl; j < p; j += vl) {
+        vl = shape->setvl(p - j);
+        size_t i = 0;
+        for (; i + shape->mr <= n; i += shape->mr) {
+            size_t next = i + shape->mr;
+            rvv_prefetch_rows(a, m, c + j, p, next, next + shape->mr < n ? next + shape->mr : n);
+            shape->block(m, a + i * m, m, b + j, p, c + i * p + j, p, vl);
+        }
+        for (; i < n; i++) {
+            shape->row(m, a + i * m, m, b + j, p, c + i * p + j, p, vl);
+        }
+    }
+    PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, p, m));
+    PROBE_KERNEL_EXIT("rvv_lmul", n, m, p);
+}
+
+// Packs columns [0, width) of B, read from Bt (width rows of ldbt), into
+// panel[k][c] = Bt[c][k]. One strided segment load gathers eight
+// consecutive k of VL columns (a cache line per column) into eight
+// registers, each then stored as a panel row; leftover k use vlse64.
+static void rvv_pack_bt(const double *bt, size_t ldbt, size_t depth, size_t width,
+                        double *panel) {
+    ptrdiff_t stride = (ptrdiff_t)(ldbt * sizeof(double));
+
+#define RVV_PACK_FIELD(f) \
+    __riscv_vse64_v_f64m1(dst + (k + (f)) * width, __riscv_vget_v_f64m1x8_f64m1(seg, f), vl);
+
+    for (size_t c = 0, vl; c < width; c += vl) {
+        vl = __riscv_vsetvl_e64m1(width - c);
+        const double *src = bt + c * ldbt;
+        double *dst = panel + c;
+        size_t k = 0;
+
+        for (; k + 8 <= depth; k += 8) {
+            vfloat64m1x8_t seg = __riscv_vlsseg8e64_v_f64m1x8(src + k, stride, vl);
+            RVV_PACK_FIELD(0) RVV_PACK_FIELD(1) RVV_PACK_FIELD(2) RVV_PACK_FIELD(3)
+            RVV_PACK_FIELD(4) RVV_PACK_FIELD(5) RVV_PACK_FIELD(6) RVV_PACK_FIELD(7)
+        }
+        for (; k < depth; k++) {
+            __riscv_vse64_v_f64m1(dst + k * width, __riscv_vlse64_v_f64m1(src + k, stride, vl), vl);
+        }
+    }
+#undef RVV_PACK_FIELD
+}
+
+// matrix_mult_rvv_lmul with B given transposed: each column strip is packed
+// from Bt into a depth x VL panel, so no transposed copy of B is made. The
+// micro-kernels and their order of terms are the same, hence so are the
+// results.
+void matrix_mult_rvv_bt(const Matrix *A, const Matrix *Bt, Matrix *C, int lmul) {
+    if (!A || !Bt || !C || !A->data || !Bt->data || !C->data) return;
+
+    // Verify dimensions
+    if (A->cols != Bt->cols || A->rows != C->rows || Bt->rows != C->cols) {
+        return; // Invalid dimensions
+    }
+
+    size_t n = A->rows;
+    size_t m = A->cols;
+    size_t p = Bt->rows;
+    const RvvShape *shape = rvv_shape(lmul ? lmul : rvv_select_lmul(n, p));
+    if (!shape) return;
+
+    size_t vlmax = shape->setvl((size_t)-1);
+    double *panel = aligned_malloc(m * vlmax * sizeof(double), CACHE_LINE_SIZE);
+    if (!panel) return;
+    PROBE_KERNEL_ENTRY("rvv_bt", n, m, p);
+
+    const double *a = A->data;
+    const double *bt = Bt->data;
+    double *c = C->data;
+
+    for (size_t j = 0, vl; j < p; j += vl) {
+        vl = shape->setvl(p - j);
+
+        PHASE_BEGIN(pack_mark);
+        PROBE_PACK_START("Bt", vl, m);
+        rvv_pack_bt(bt + j * m, m, m, vl, panel);
+        PROBE_PACK_END("Bt", vl, m);
+        PHASE_END(pack_mark, PHASE_PACK_B, 2 * m * vl * sizeof(double));
+
+        // The next strip's Bt rows arrive while this one is computed
+        for (size_t r = j + vl; r < p && r < j + 2 * vl; r++) {
+            PREFETCH(bt + r * m);
+        }
+
+        PHASE_BEGIN(kernel_mark);
+        size_t i = 0;
+        for (; i + shape->mr <= n; i += shape->mr) {
+            size_t next = i + shape->mr;
+            rvv_prefetch_rows(a, m, c + j, p, next, next + shape->mr < n ? next + shape->mr : n);
+            shape->block(m, a + i * m, m, panel, vl, c + i * p + j, p, vl);
+        }
+        for (; i < n; i++) {
+            shape->row(m, a + i * m, m, panel, vl, c + i * p + j, p, vl);
+        }
+        PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, vl, m));
+    }
+    aligned_free(panel);
+    PROBE_KERNEL_EXIT("rvv_bt", n, m, p);
+}
+
+// Registration
+static void run_rvv(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_rvv(args->A, args->B, args->C);
+}
+
+#define DEFINE_RVV_RUN(lmul)                                                            \
+    static void run_rvv_m##lmul(void *ctx) {                                            \
+        const KernelArgs *args = ctx;                                                   \
+        matrix_mult_rvv_lmul(args->A, args->B, args->C, lmul);                          \
+    }
+
+DEFINE_RVV_RUN(0)
+DEFINE_RVV_RUN(1)
+DEFINE_RVV_RUN(2)
+DEFINE_RVV_RUN(4)
+DEFINE_RVV_RUN(8)
+
+static void run_rvv_bt(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_rvv_bt(args->A, args->Bt, args->C, 0);
+}
+
+// A strip of VL columns of B stays cached while every row block passes
+// over it; A is read once per strip
+static double traffic_rvv_lmul(size_t n, int lmul, size_t cache_bytes) {
+    double dn = (double)n;
+    const RvvShape *shape = rvv_shape(lmul ? lmul : rvv_select_lmul(n, n));
+    double vl = (double)(__riscv_vlenb() / sizeof(double) * shape->lmul);
+    double strips = (dn + vl - 1.0) / vl;
+    double strip_bytes = dn * vl * sizeof(double);
+
+    if (3.0 * dn * dn * sizeof(double) <= (double)cache_bytes) {
+        return 4.0 * dn * dn * sizeof(double);
+    }
+    double b_bytes = strip_bytes <= (double)cache_bytes
+                   ? dn * dn * sizeof(double)
+                   : strips * (dn / shape->mr) * strip_bytes;
+    return strips * dn * dn * sizeof(double) + b_bytes + 2.0 * dn * dn * sizeof(double);
+}
+
+#define DEFINE_RVV_TRAFFIC(lmul)                                                        \
+    static double traffic_rvv_m##lmul(size_t n, size_t tile, size_t cache_bytes) {      \
+        (void)tile;                                                                     \
+        return traffic_rvv_lmul(n, lmul, cache_bytes);                                  \
+    }
+
+DEFINE_RVV_TRAFFIC(0)
+DEFINE_RVV_TRAFFIC(1)
+DEFINE_RVV_TRAFFIC(2)
+DEFINE_RVV_TRAFFIC(4)
+DEFINE_RVV_TRAFFIC(8)
+
+// ikj over whole rows, C in memory
+static void blocking_rvv(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)tile;
+    (void)threads;
+    *out = (ModelBlocking){ n, n, n, 1, n, 1, 1 };
+}
+
+// All rows and the full depth per strip, MR x VL of C in registers
+static void blocking_rvv_lmul(size_t n, int lmul, ModelBlocking *out) {
+    const RvvShape *shape = rvv_shape(lmul ? lmul : rvv_select_lmul(n, n));
+    size_t vl = __riscv_vlenb() / sizeof(double) * shape->lmul;
+    *out = (ModelBlocking){ n, n, vl, shape->mr, vl, n, 1 };
+}
+
+#define DEFINE_RVV_BLOCKING(lmul)                                                       \
+    static void blocking_rvv_m##lmul(size_t n, size_t tile, int threads,                \
+                                     ModelBlocking *out) {                              \
+        (void)tile;                                                                     \
+        (void)threads;                                                                  \
+        blocking_rvv_lmul(n, lmul, out);                                                \
+    }
+
+DEFINE_RVV_BLOCKING(0)
+DEFINE_RVV_BLOCKING(1)
+DEFINE_RVV_BLOCKING(2)
+DEFINE_RVV_BLOCKING(4)
+DEFINE_RVV_BLOCKING(8)
+
+#if RVV_EMULATED
+#define RVV_EMULATION_NOTE " (emulated)"
+#else
+#define RVV_EMULATION_NOTE ""
+#endif
+
+REGISTER_KERNEL(rvv,
+    .name = "RVV", .description = "RVV intrinsics" RVV_EMULATION_NOTE, .run = run_rvv,
+    .isa = "rvv", .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT,
+    .traffic = roofline_traffic_vector, .blocking = blocking_rvv, .order = 40)
+
+#define REGISTER_RVV_LMUL(lmul, label, what, position)                                  \
+    REGISTER_KERNEL(rvv_m##lmul,                                                        \
+        .name = label, .description = what RVV_EMULATION_NOTE, .run = run_rvv_m##lmul,  \
+        .isa = "rvv", .flags = KERNEL_USES_PREFETCH, .dtypes = KERNEL_DTYPE_F64,        \
+        .shapes = KERNEL_SHAPE_RECT, .traffic = traffic_rvv_m##lmul,                    \
+        .blocking = blocking_rvv_m##lmul, .order = position)
+
+REGISTER_RVV_LMUL(0, "RVV-auto", "RVV register-blocked, LMUL by vlenb and shape", 41)
+REGISTER_RVV_LMUL(1, "RVV-m1", "RVV register-blocked, LMUL 1, 28 rows", 42)
+REGISTER_RVV_LMUL(2, "RVV-m2", "RVV register-blocked, LMUL 2, 12 rows", 43)
+REGISTER_RVV_LMUL(4, "RVV-m4", "RVV register-blocked, LMUL 4, 6 rows", 44)
+REGISTER_RVV_LMUL(8, "RVV-m8", "RVV register-blocked, LMUL 8, 3 rows", 45)
+
+REGISTER_KERNEL(rvv_bt,
+    .name = "RVV-Bt", .description = "RVV register-blocked, B transposed" RVV_EMULATION_NOTE,
+    .run = run_rvv_bt, .isa = "rvv", .flags = KERNEL_TRANSPOSED_B | KERNEL_USES_PREFETCH,
+    .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT, .traffic = traffic_rvv_m0,
+    .blocking = blocking_rvv_m0, .order = 46)
+
+#endif // USE_VECTOR
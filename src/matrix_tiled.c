@@ -1,8 +1,148 @@
 #include "matrix.h"
 #include "utils.h"
+#include "phase_timing.h"
+#include "probes.h"
+#include "kernel_registry.h"
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
 
+// Register block of the TiledReg micro-kernel: 16 accumulators plus two
+// sets of 4 A and 4 B operands fill the 32 FP registers of RV64GC
+#define TILE_MR 4
+#define TILE_NR 4
+
+#define TILE_LOAD(s, k)                                                         \
+    s##a0 = a[(k)];            s##b0 = b[(k) * ldb];                            \
+    s##a1 = a[lda + (k)];      s##b1 = b[(k) * ldb + 1];                        \
+    s##a2 = a[2 * lda + (k)];  s##b2 = b[(k) * ldb + 2];                        \
+    s##a3 = a[3 * lda + (k)];  s##b3 = b[(k) * ldb + 3];
+
+#define TILE_FMA_ROW(s, r)                                                      \
+    c##r##0 += s##a##r * s##b0; c##r##1 += s##a##r * s##b1;                     \
+    c##r##2 += s##a##r * s##b2; c##r##3 += s##a##r * s##b3;
+
+#define TILE_FMA(s) TILE_FMA_ROW(s, 0) TILE_FMA_ROW(s, 1) TILE_FMA_ROW(s, 2) TILE_FMA_ROW(s, 3)
+
+#define TILE_C_ROW(op, r)                                                       \
+    op(r, 0) op(r, 1) op(r, 2) op(r, 3)
+#define TILE_C_LOAD(r, j)  double c##r##j = c[(r) * ldc + (j)];
+#define TILE_C_STORE(r, j) c[(r) * ldc + (j)] = c##r##j;
+
+// Two pipelined steps: operands of k + 1 and k + 2 are loaded under the
+// multiply-adds of k and k + 1
+#define TILE_STEP2(k)                                                           \
+    TILE_LOAD(y, (k) + 1)                                                       \
+    TILE_FMA(x)                                                                 \
+    TILE_LOAD(x, (k) + 2)                                                       \
+    TILE_FMA(y)
+
+// C[0,4)[0,4) += A[0,4)[0,depth) * B[0,depth)[0,4), software-pipelined for
+// in-order cores: the operands of step k + 1 are loaded before the 16
+// multiply-adds of step k (fmadd.d under -ffast-math), so none waits on the
+// load feeding it. Unrolled by two, the operand sets x and y swap roles
+// without moves. Each C element adds its k terms in order, like the dot
+// loop of matrix_mult_tiled. Not inlined, so the block keeps all 32
+// registers and the schedule can be read from the disassembly. While
+// k + matrix_prefetch_distance is within reach of B, past the end of the
+// tile, the first loop also prefetches that row of B; a branch in the
+// pipelined loop would cost more than the prefetch saves.
+static __attribute__((noinline)) void tile_micro_4x4(size_t depth, size_t reach, const double *a,
+                                                     size_t lda, const double *b, size_t ldb,
+                                                     double *c, size_t ldc) {
+    double xa0, xa1, xa2, xa3, xb0, xb1, xb2, xb3;
+    double ya0, ya1, ya2, ya3, yb0, yb1, yb2, yb3;
+    size_t dist = matrix_prefetch_distance;
+    size_t pf_end = PREFETCH_END(dist, reach);
+    size_t k = 0;
+
+    if (depth == 0) return;
+    TILE_C_ROW(TILE_C_LOAD, 0) TILE_C_ROW(TILE_C_LOAD, 1)
+    TILE_C_ROW(TILE_C_LOAD, 2) TILE_C_ROW(TILE_C_LOAD, 3)
+
+    TILE_LOAD(x, 0)
+    for (; k + 2 < depth && k + 1 < pf_end; k += 2) {
+        PREFETCH(b + (k + dist) * ldb);
+        PREFETCH(b + (k + 1 + dist) * ldb);
+        TILE_STEP2(k)
+    }
+    for (; k + 2 < depth; k += 2) {
+        TILE_STEP2(k)
+    }
+    if (k + 1 < depth) {
+        TILE_LOAD(y, k + 1)
+        TILE_FMA(x)
+        TILE_FMA(y)
+    } else {
+        TILE_FMA(x)
+    }
+
+    TILE_C_ROW(TILE_C_STORE, 0) TILE_C_ROW(TILE_C_STORE, 1)
+    TILE_C_ROW(TILE_C_STORE, 2) TILE_C_ROW(TILE_C_STORE, 3)
+}
+
+// One rows x cols x depth tile: 4 x 4 register blocks, dot products for the
+// rows and columns left over. Each block row prefetches the next, which
+// in-order cores without a hardware prefetcher would otherwise wait for;
+// reach is the rows of B from b to the end of the matrix.
+static void tile_update_register(size_t rows, size_t cols, size_t depth, size_t reach,
+                                 const double *a, size_t lda, const double *b, size_t ldb,
+                                 double *c, size_t ldc) {
+    size_t block_rows = rows - rows % TILE_MR;
+    size_t block_cols = cols - cols % TILE_NR;
+
+    for (size_t i = 0; i < block_rows; i += TILE_MR) {
+        // The next block row's A and C lines, for reading and for writing
+        for (size_t r = i + TILE_MR; r < i + 2 * TILE_MR && r < rows; r++) {
+            PREFETCH(a + r * lda);
+            PREFETCH_W(c + r * ldc);
+        }
+        for (size_t j = 0; j < block_cols; j += TILE_NR) {
+            tile_micro_4x4(depth, reach, a + i * lda, lda, b + j, ldb, c + i * ldc + j, ldc);
+        }
+    }
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = i < block_rows ? block_cols : 0; j < cols; j++) {
+            double sum = c[i * ldc + j];
+            for (size_t k = 0; k < depth; k++) {
+                sum += a[i * lda + k] * b[k * ldb + j];
+            }
+            c[i * ldc + j] = sum;
+        }
+    }
+}
+
+#if !TILED_REGISTER_BLOCK
+// sum plus the dot product of row i of A and column j of B over k in
+// [kk, k_end) that, while k < pf_end, prefetches the B line of column j
+// and/or, once per line, the A line of row i matrix_prefetch_distance steps
+// ahead. The k are split at pf_end so neither part tests per step. Out of
+// line, the dot loop compiles as it would without prefetching.
+static __attribute__((noinline)) double tile_dot_prefetched(const Matrix *A, const Matrix *B,
+                                                            size_t i, size_t j, size_t kk,
+                                                            size_t k_end, size_t pf_end,
+                                                            int b_lines, int a_lines,
+                                                            double sum) {
+    size_t dist = matrix_prefetch_distance;
+    size_t end = k_end < pf_end ? k_end : pf_end;
+    size_t k = kk;
+
+    for (; k < end; k++) {
+        if (b_lines) {
+            PREFETCH(&MATRIX_GET(B, k + dist, j));
+        }
+        if (a_lines && (k - kk) % PREFETCH_LINE_DOUBLES == 0) {
+            PREFETCH(&MATRIX_GET(A, i, k + dist));
+        }
+        sum += MATRIX_GET(A, i, k) * MATRIX_GET(B, k, j);
+    }
+    for (; k < k_end; k++) {
+        sum += MATRIX_GET(A, i, k) * MATRIX_GET(B, k, j);
+    }
+    return sum;
+}
+#endif
+
 // Cache-aware matrix multiplication using loop tiling/blocking
 void matrix_mult_tiled(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_size) {
     if (!A || !B || !C || !A->data || !B->data || !C->data) return;
@@ -15,9 +155,15 @@ void matrix_mult_tiled(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_
     size_t n = A->rows;
     size_t m = A->cols;
     size_t p = B->cols;
+#if !TILED_REGISTER_BLOCK
+    size_t pf_end = PREFETCH_END(matrix_prefetch_distance, m);
+#endif
+    PROBE_KERNEL_ENTRY("tiled", n, m, p);
     
     // Initialize result matrix to zero
+    PHASE_BEGIN(zero_mark);
     matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
     
     // Tiled matrix multiplication with blocking
     // This improves cache locality by working on smaller sub-matrices (tiles)
@@ -33,13 +179,30 @@ void matrix_mult_tiled(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_
                 size_t k_end = (kk + tile_size < m) ? kk + tile_size : m;
                 
                 // Perform multiplication on the current tile
+                PROBE_TILE_START(ii, jj, kk);
+                PHASE_BEGIN(tile_mark);
+#if TILED_REGISTER_BLOCK
+                tile_update_register(i_end - ii, j_end - jj, k_end - kk, m - kk,
+                                     &MATRIX_GET(A, ii, kk), m, &MATRIX_GET(B, kk, jj), p,
+                                     &MATRIX_GET(C, ii, jj), p);
+#else
                 for (size_t i = ii; i < i_end; i++) {
                     for (size_t j = jj; j < j_end; j++) {
                         double sum = MATRIX_GET(C, i, j);
+                        int b_lines = i == ii && j % PREFETCH_LINE_DOUBLES == 0;
+                        
+                        // Lines of B are prefetched by the first row of the
+                        // tile and first column of the line to read them, A
+                        // lines by the first column of the tile
+                        if (kk < pf_end && (b_lines || j == jj)) {
+                            MATRIX_SET(C, i, j, tile_dot_prefetched(A, B, i, j, kk, k_end, pf_end,
+                                                                    b_lines, j == jj, sum));
+                            continue;
+                        }
                         
                         // Inner loop unrolling for better performance
                         size_t k = kk;
-                        for (; k < k_end - 3; k += 4) {
+                        for (; k + 3 < k_end; k += 4) {
                             sum += MATRIX_GET(A, i, k)     * MATRIX_GET(B, k,     j);
                             sum += MATRIX_GET(A, i, k + 1) * MATRIX_GET(B, k + 1, j);
                             sum += MATRIX_GET(A, i, k + 2) * MATRIX_GET(B, k + 2, j);
@@ -54,9 +217,92 @@ void matrix_mult_tiled(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_
                         MATRIX_SET(C, i, j, sum);
                     }
                 }
+#endif
+                PHASE_END(tile_mark, PHASE_MICRO_KERNEL,
+                          TILE_FOOTPRINT_BYTES(i_end - ii, j_end - jj, k_end - kk));
+                PROBE_TILE_END(ii, jj, kk);
             }
         }
     }
+    PROBE_KERNEL_EXIT("tiled", n, m, p);
+}
+
+// matrix_mult_tiled on 4 x 4 register blocks whatever TILED_REGISTER_BLOCK,
+// for comparing the two on any machine
+void matrix_mult_tiled_register(const Matrix *A, const Matrix *B, Matrix *C, size_t tile_size) {
+    if (!A || !B || !C || !A->data || !B->data || !C->data) return;
+    
+    // Verify dimensions
+    if (A->cols != B->rows || A->rows != C->rows || B->cols != C->cols) {
+        return; // Invalid dimensions
+    }
+    
+    size_t n = A->rows;
+    size_t m = A->cols;
+    size_t p = B->cols;
+    PROBE_KERNEL_ENTRY("tiled_register", n, m, p);
+    
+    PHASE_BEGIN(zero_mark);
+    matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
+    
+    for (size_t ii = 0; ii < n; ii += tile_size) {
+        for (size_t jj = 0; jj < p; jj += tile_size) {
+            for (size_t kk = 0; kk < m; kk += tile_size) {
+                size_t i_end = (ii + tile_size < n) ? ii + tile_size : n;
+                size_t j_end = (jj + tile_size < p) ? jj + tile_size : p;
+                size_t k_end = (kk + tile_size < m) ? kk + tile_size : m;
+                
+                PROBE_TILE_START(ii, jj, kk);
+                PHASE_BEGIN(tile_mark);
+                tile_update_register(i_end - ii, j_end - jj, k_end - kk, m - kk,
+                                     &MATRIX_GET(A, ii, kk), m, &MATRIX_GET(B, kk, jj), p,
+                                     &MATRIX_GET(C, ii, jj), p);
+                PHASE_END(tile_mark, PHASE_MICRO_KERNEL,
+                          TILE_FOOTPRINT_BYTES(i_end - ii, j_end - jj, k_end - kk));
+                PROBE_TILE_END(ii, jj, kk);
+            }
+        }
+    }
+    PROBE_KERNEL_EXIT("tiled_register", n, m, p);
+}
+
+// ikj update of row i over k in [kk, k_end) and columns [jj, j_end) that,
+// while k < pf_end, prefetches the B row matrix_prefetch_distance steps
+// ahead and, once per line, A. The k are split at pf_end so neither part
+// tests per step. Used for the first row of a tile, which brings each B
+// row in for the rest, by TiledOpt and VectorOpt; out of line, the loop
+// nests of the callers compile as they would without it.
+__attribute__((noinline)) void matrix_tile_row_prefetched(const Matrix *A, const Matrix *B,
+                                                          Matrix *C, size_t i, size_t kk,
+                                                          size_t k_end, size_t jj,
+                                                          size_t j_end, size_t pf_end) {
+    size_t dist = matrix_prefetch_distance;
+    size_t end = k_end < pf_end ? k_end : pf_end;
+    size_t k = kk;
+
+    while (k < end) {
+        size_t line_end = k + PREFETCH_LINE_DOUBLES < end ? k + PREFETCH_LINE_DOUBLES : end;
+
+        PREFETCH(&MATRIX_GET(A, i, k + dist));
+        for (; k < line_end; k++) {
+            double a_ik = MATRIX_GET(A, i, k);
+
+            for (size_t j = jj; j < j_end; j += PREFETCH_LINE_DOUBLES) {
+                PREFETCH(&MATRIX_GET(B, k + dist, j));
+            }
+            for (size_t j = jj; j < j_end; j++) {
+                MATRIX_SET(C, i, j, MATRIX_GET(C, i, j) + a_ik * MATRIX_GET(B, k, j));
+            }
+        }
+    }
+    for (; k < k_end; k++) {
+        double a_ik = MATRIX_GET(A, i, k);
+
+        for (size_t j = jj; j < j_end; j++) {
+            MATRIX_SET(C, i, j, MATRIX_GET(C, i, j) + a_ik * MATRIX_GET(B, k, j));
+        }
+    }
 }
 
 // Alternative implementation with better cache access pattern
@@ -71,9 +317,13 @@ void matrix_mult_tiled_optimized(const Matrix *A, const Matrix *B, Matrix *C, si
     size_t n = A->rows;
     size_t m = A->cols;
     size_t p = B->cols;
+    size_t pf_end = PREFETCH_END(matrix_prefetch_distance, m);
+    PROBE_KERNEL_ENTRY("tiled_optimized", n, m, p);
     
     // Initialize result matrix to zero
+    PHASE_BEGIN(zero_mark);
     matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
     
     // Optimized tiling with better memory access patterns
     // Use ikj loop order within tiles for better cache performance
@@ -88,7 +338,13 @@ void matrix_mult_tiled_optimized(const Matrix *A, const Matrix *B, Matrix *C, si
                 size_t j_end = (jj + tile_size < p) ? jj + tile_size : p;
                 
                 // ikj order within tile for better cache locality
+                PROBE_TILE_START(ii, jj, kk);
+                PHASE_BEGIN(tile_mark);
                 for (size_t i = ii; i < i_end; i++) {
+                    if (i == ii && kk < pf_end) {
+                        matrix_tile_row_prefetched(A, B, C, i, kk, k_end, jj, j_end, pf_end);
+                        continue;
+                    }
                     for (size_t k = kk; k < k_end; k++) {
                         double a_ik = MATRIX_GET(A, i, k);
                         
@@ -99,9 +355,13 @@ void matrix_mult_tiled_optimized(const Matrix *A, const Matrix *B, Matrix *C, si
                         }
                     }
                 }
+                PHASE_END(tile_mark, PHASE_MICRO_KERNEL,
+                          TILE_FOOTPRINT_BYTES(i_end - ii, j_end - jj, k_end - kk));
+                PROBE_TILE_END(ii, jj, kk);
             }
         }
     }
+    PROBE_KERNEL_EXIT("tiled_optimized", n, m, p);
 }
 
 // Function to determine optimal tile size based on cache size
@@ -131,3 +391,62 @@ size_t calculate_optimal_tile_size(size_t cache_size_bytes, size_t element_size)
     
     return power_of_2;
 }
+
+// Registration
+static void run_tiled(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_tiled(args->A, args->B, args->C, args->tile_size);
+}
+
+static void run_tiled_register(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_tiled_register(args->A, args->B, args->C, args->tile_size);
+}
+
+static void run_tiled_optimized(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_tiled_optimized(args->A, args->B, args->C, args->tile_size);
+}
+
+// 4 x 4 blocks of C in registers over each k tile
+static void blocking_tiled_register(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)n;
+    (void)threads;
+    *out = (ModelBlocking){ tile, tile, tile, TILE_MR, TILE_NR, tile, 1 };
+}
+
+// Dot products over each k tile in a register
+static void blocking_tiled(size_t n, size_t tile, int threads, ModelBlocking *out) {
+#if TILED_REGISTER_BLOCK
+    blocking_tiled_register(n, tile, threads, out);
+#else
+    (void)n;
+    (void)threads;
+    *out = (ModelBlocking){ tile, tile, tile, 1, 1, tile, 1 };
+#endif
+}
+
+// ikj: a row of the C tile is updated in memory for every k
+static void blocking_tiled_optimized(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)n;
+    (void)threads;
+    *out = (ModelBlocking){ tile, tile, tile, 1, tile, 1, 1 };
+}
+
+REGISTER_KERNEL(tiled,
+    .name = "Tiled", .description = "cache-aware tiled", .run = run_tiled, .isa = "scalar",
+    .flags = KERNEL_USES_TILE | KERNEL_USES_PREFETCH, .dtypes = KERNEL_DTYPE_F64,
+    .shapes = KERNEL_SHAPE_RECT, .traffic = roofline_traffic_tiled, .blocking = blocking_tiled,
+    .order = 10)
+
+REGISTER_KERNEL(tiled_register,
+    .name = "TiledReg", .description = "tiled, 4x4 software-pipelined register blocks",
+    .run = run_tiled_register, .isa = "scalar", .flags = KERNEL_USES_TILE | KERNEL_USES_PREFETCH,
+    .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT, .traffic = roofline_traffic_tiled,
+    .blocking = blocking_tiled_register, .order = 12)
+
+REGISTER_KERNEL(tiled_optimized,
+    .name = "TiledOpt", .description = "optimized tiled", .run = run_tiled_optimized,
+    .isa = "scalar", .flags = KERNEL_USES_TILE | KERNEL_USES_PREFETCH,
+    .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT, .traffic = roofline_traffic_tiled,
+    .blocking = blocking_tiled_optimized, .order = 15)
@@ -1,10 +1,18 @@
 #include "matrix.h"
 #include "utils.h"
+#include "phase_timing.h"
+#include "probes.h"
+#include "kernel_registry.h"
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
 
 #ifdef USE_VECTOR
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
 // RISC-V Vector Extension includes
 // Note: These would be actual RISC-V vector intrinsics in a real implementation
 // For this example, we'll simulate vector operations with optimized scalar code
@@ -12,6 +20,9 @@
 // Simulated vector length for demonstration
 #define VECTOR_LENGTH 8
 
+// Tile edge of matrix_mult_vector_optimized
+#define VECTOR_TILE_SIZE 64
+
 // Vector matrix multiplication using RISC-V vector extensions
 void matrix_mult_vector(const Matrix *A, const Matrix *B, Matrix *C) {
     if (!A || !B || !C || !A->data || !B->data || !C->data) return;
@@ -24,21 +35,42 @@ void matrix_mult_vector(const Matrix *A, const Matrix *B, Matrix *C) {
     size_t n = A->rows;
     size_t m = A->cols;
     size_t p = B->cols;
+    size_t pf_end = PREFETCH_END(matrix_prefetch_distance, m);
+    PROBE_KERNEL_ENTRY("vector", n, m, p);
     
     // Initialize result matrix to zero
+    PHASE_BEGIN(zero_mark);
     matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
     
     // Vector-optimized matrix multiplication
     // In a real RISC-V implementation, this would use vector load/store and
     // vector multiply-accumulate instructions
     
+    PHASE_BEGIN(kernel_mark);
     for (size_t i = 0; i < n; i++) {
+        // B rows outgrow the cache at large sizes. The first row of each
+        // VECTOR_TILE_SIZE block prefetches B dist steps ahead for the rows
+        // after it; every row prefetches its own A once per line.
+        int prefetch_b = i % VECTOR_TILE_SIZE == 0;
+
         for (size_t k = 0; k < m; k++) {
             double a_ik = MATRIX_GET(A, i, k);
             
+            if (k < pf_end) {
+                if (k % PREFETCH_LINE_DOUBLES == 0) {
+                    PREFETCH(&MATRIX_GET(A, i, k + matrix_prefetch_distance));
+                }
+                if (prefetch_b) {
+                    for (size_t j = 0; j < p; j += PREFETCH_LINE_DOUBLES) {
+                        PREFETCH(&MATRIX_GET(B, k + matrix_prefetch_distance, j));
+                    }
+                }
+            }
+            
             // Process VECTOR_LENGTH elements at a time
             size_t j = 0;
-            for (; j <= p - VECTOR_LENGTH; j += VECTOR_LENGTH) {
+            for (; j + VECTOR_LENGTH <= p; j += VECTOR_LENGTH) {
                 // Simulate vector operations
                 // In real RISC-V vector code, this would be:
                 // vl = vsetvli(zero, VECTOR_LENGTH, e64, m1, ta, ma);
@@ -60,6 +92,8 @@ void matrix_mult_vector(const Matrix *A, const Matrix *B, Matrix *C) {
             }
         }
     }
+    PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, p, m));
+    PROBE_KERNEL_EXIT("vector", n, m, p);
 }
 
 // Optimized vector implementation with better vectorization
@@ -74,12 +108,16 @@ void matrix_mult_vector_optimized(const Matrix *A, const Matrix *B, Matrix *C) {
     size_t n = A->rows;
     size_t m = A->cols;
     size_t p = B->cols;
+    size_t pf_end = PREFETCH_END(matrix_prefetch_distance, m);
+    PROBE_KERNEL_ENTRY("vector_optimized", n, m, p);
     
     // Initialize result matrix to zero
+    PHASE_BEGIN(zero_mark);
     matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
     
     // Combine tiling with vectorization for optimal performance
-    const size_t tile_size = 64; // Optimized for vector processing
+    const size_t tile_size = VECTOR_TILE_SIZE;
     
     for (size_t ii = 0; ii < n; ii += tile_size) {
         for (size_t kk = 0; kk < m; kk += tile_size) {
@@ -90,13 +128,20 @@ void matrix_mult_vector_optimized(const Matrix *A, const Matrix *B, Matrix *C) {
                 size_t j_end = (jj + tile_size < p) ? jj + tile_size : p;
                 
                 // Vector processing within tiles
+                PROBE_TILE_START(ii, jj, kk);
+                PHASE_BEGIN(tile_mark);
                 for (size_t i = ii; i < i_end; i++) {
+                    // The first row of the tile prefetches for the rest
+                    if (i == ii && kk < pf_end) {
+                        matrix_tile_row_prefetched(A, B, C, i, kk, k_end, jj, j_end, pf_end);
+                        continue;
+                    }
                     for (size_t k = kk; k < k_end; k++) {
                         double a_ik = MATRIX_GET(A, i, k);
                         
                         // Vectorized inner loop
                         size_t j = jj;
-                        for (; j <= j_end - VECTOR_LENGTH; j += VECTOR_LENGTH) {
+                        for (; j + VECTOR_LENGTH <= j_end; j += VECTOR_LENGTH) {
                             // Simulated vector FMA operations
                             for (size_t vj = 0; vj < VECTOR_LENGTH; vj++) {
                                 MATRIX_SET(C, i, j + vj, 
@@ -111,43 +156,182 @@ void matrix_mult_vector_optimized(const Matrix *A, const Matrix *B, Matrix *C) {
                         }
                     }
                 }
+                PHASE_END(tile_mark, PHASE_MICRO_KERNEL,
+                          TILE_FOOTPRINT_BYTES(i_end - ii, j_end - jj, k_end - kk));
+                PROBE_TILE_END(ii, jj, kk);
             }
         }
     }
+    PROBE_KERNEL_EXIT("vector_optimized", n, m, p);
 }
 
-// Example of how real RISC-V vector intrinsics would look
-/*
-#include <riscv_vector.h>
+// Packs columns [0, width) of B, read from Bt (width rows of ldbt), into
+// panel[k][c] = Bt[c][k]. With AVX, 4 x 4 blocks are transposed in
+// registers: four row loads of Bt, two rounds of shuffles, four panel
+// stores. Gathers would fetch one element per lane instead.
+static void vector_pack_bt(const double *bt, size_t ldbt, size_t depth, size_t width,
+                           double *panel) {
+    size_t c = 0;
+#if defined(__AVX__)
+    for (; c + 4 <= width; c += 4) {
+        const double *r0 = bt + c * ldbt;
+        const double *r1 = r0 + ldbt;
+        const double *r2 = r1 + ldbt;
+        const double *r3 = r2 + ldbt;
+        size_t k = 0;
 
-void matrix_mult_vector_real(const Matrix *A, const Matrix *B, Matrix *C) {
+        for (; k + 4 <= depth; k += 4) {
+            __m256d x0 = _mm256_loadu_pd(r0 + k);
+            __m256d x1 = _mm256_loadu_pd(r1 + k);
+            __m256d x2 = _mm256_loadu_pd(r2 + k);
+            __m256d x3 = _mm256_loadu_pd(r3 + k);
+            __m256d t0 = _mm256_unpacklo_pd(x0, x1);    // k, k+2 of rows 0, 1
+            __m256d t1 = _mm256_unpackhi_pd(x0, x1);    // k+1, k+3
+            __m256d t2 = _mm256_unpacklo_pd(x2, x3);
+            __m256d t3 = _mm256_unpackhi_pd(x2, x3);
+            _mm256_storeu_pd(panel + k * width + c, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(panel + (k + 1) * width + c, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(panel + (k + 2) * width + c, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(panel + (k + 3) * width + c, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+        for (; k < depth; k++) {
+            panel[k * width + c] = r0[k];
+            panel[k * width + c + 1] = r1[k];
+            panel[k * width + c + 2] = r2[k];
+            panel[k * width + c + 3] = r3[k];
+        }
+    }
+#endif
+    for (; c < width; c++) {
+        for (size_t k = 0; k < depth; k++) {
+            panel[k * width + c] = bt[c * ldbt + k];
+        }
+    }
+}
+
+// matrix_mult_vector with B given transposed: strips of VECTOR_TILE_SIZE
+// columns are packed from Bt into a depth x strip panel, so no transposed
+// copy of B is made
+void matrix_mult_vector_bt(const Matrix *A, const Matrix *Bt, Matrix *C) {
+    if (!A || !Bt || !C || !A->data || !Bt->data || !C->data) return;
+    
+    // Verify dimensions
+    if (A->cols != Bt->cols || A->rows != C->rows || Bt->rows != C->cols) {
+        return; // Invalid dimensions
+    }
+    
     size_t n = A->rows;
     size_t m = A->cols;
-    size_t p = B->cols;
+    size_t p = Bt->rows;
+    double *panel = aligned_malloc(m * VECTOR_TILE_SIZE * sizeof(double), CACHE_LINE_SIZE);
+    if (!panel) return;
+    PROBE_KERNEL_ENTRY("vector_bt", n, m, p);
     
+    PHASE_BEGIN(zero_mark);
     matrix_init_zero(C);
+    PHASE_END(zero_mark, PHASE_ZERO, n * p * sizeof(double));
     
-    for (size_t i = 0; i < n; i++) {
-        for (size_t k = 0; k < m; k++) {
-            double a_ik = MATRIX_GET(A, i, k);
-            
-            size_t j = 0;
-            size_t vl;
-            while (j < p) {
-                vl = vsetvli(p - j, RVV_E64, RVV_M1);
-                
-                vfloat64m1_t vb = vle64_v_f64m1(&MATRIX_GET(B, k, j), vl);
-                vfloat64m1_t vc = vle64_v_f64m1(&MATRIX_GET(C, i, j), vl);
-                
-                vc = vfmacc_vf_f64m1(vc, a_ik, vb, vl);
-                
-                vse64_v_f64m1(&MATRIX_GET(C, i, j), vc, vl);
-                
-                j += vl;
+    const double *a = A->data;
+    const double *bt = Bt->data;
+    double *c = C->data;
+    
+    for (size_t jj = 0; jj < p; jj += VECTOR_TILE_SIZE) {
+        size_t width = (jj + VECTOR_TILE_SIZE < p) ? VECTOR_TILE_SIZE : p - jj;
+        
+        PHASE_BEGIN(pack_mark);
+        PROBE_PACK_START("Bt", width, m);
+        vector_pack_bt(bt + jj * m, m, m, width, panel);
+        PROBE_PACK_END("Bt", width, m);
+        PHASE_END(pack_mark, PHASE_PACK_B, 2 * m * width * sizeof(double));
+        
+        PHASE_BEGIN(kernel_mark);
+        for (size_t i = 0; i < n; i++) {
+            double *c_row = c + i * p + jj;
+            for (size_t k = 0; k < m; k++) {
+                double a_ik = a[i * m + k];
+                const double *b_row = panel + k * width;
+                for (size_t j = 0; j < width; j++) {
+                    c_row[j] += a_ik * b_row[j];
+                }
             }
         }
+        PHASE_END(kernel_mark, PHASE_MICRO_KERNEL, TILE_FOOTPRINT_BYTES(n, width, m));
     }
+    aligned_free(panel);
+    PROBE_KERNEL_EXIT("vector_bt", n, m, p);
+}
+
+// Registration
+static void run_vector(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_vector(args->A, args->B, args->C);
+}
+
+static void run_vector_optimized(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_vector_optimized(args->A, args->B, args->C);
+}
+
+static void run_vector_bt(void *ctx) {
+    const KernelArgs *args = ctx;
+    matrix_mult_vector_bt(args->A, args->Bt, args->C);
+}
+
+static double traffic_vector_optimized(size_t n, size_t tile, size_t cache_bytes) {
+    (void)tile;
+    return roofline_traffic_tiled(n, VECTOR_TILE_SIZE, cache_bytes);
 }
-*/
+
+// ikj over whole rows, and over VECTOR_TILE_SIZE tiles
+static void blocking_vector(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)tile;
+    (void)threads;
+    *out = (ModelBlocking){ n, n, n, 1, n, 1, 1 };
+}
+
+static void blocking_vector_optimized(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    (void)n;
+    (void)tile;
+    (void)threads;
+    *out = (ModelBlocking){ VECTOR_TILE_SIZE, VECTOR_TILE_SIZE, VECTOR_TILE_SIZE,
+                            1, VECTOR_TILE_SIZE, 1, 1 };
+}
+
+// A once per strip; Bt once, through the panel; C read and written
+static double traffic_vector_bt(size_t n, size_t tile, size_t cache_bytes) {
+    double dn = (double)n;
+    double strips = (dn + VECTOR_TILE_SIZE - 1) / VECTOR_TILE_SIZE;
+    (void)tile;
+
+    if (3.0 * dn * dn * sizeof(double) <= (double)cache_bytes) {
+        return 4.0 * dn * dn * sizeof(double);
+    }
+    return (strips + 3.0) * dn * dn * sizeof(double);
+}
+
+// Whole rows of A over a VECTOR_TILE_SIZE column strip
+static void blocking_vector_bt(size_t n, size_t tile, int threads, ModelBlocking *out) {
+    size_t strip = n < VECTOR_TILE_SIZE ? n : VECTOR_TILE_SIZE;
+    (void)tile;
+    (void)threads;
+    *out = (ModelBlocking){ n, n, strip, 1, strip, 1, 1 };
+}
+
+REGISTER_KERNEL(vector,
+    .name = "Vector", .description = "vector", .run = run_vector, .isa = "vector",
+    .flags = KERNEL_USES_PREFETCH, .dtypes = KERNEL_DTYPE_F64, .shapes = KERNEL_SHAPE_RECT,
+    .traffic = roofline_traffic_vector, .blocking = blocking_vector, .order = 30)
+
+REGISTER_KERNEL(vector_optimized,
+    .name = "VectorOpt", .description = "optimized vector", .run = run_vector_optimized,
+    .isa = "vector", .flags = KERNEL_USES_PREFETCH, .dtypes = KERNEL_DTYPE_F64,
+    .shapes = KERNEL_SHAPE_RECT, .traffic = traffic_vector_optimized,
+    .blocking = blocking_vector_optimized, .order = 35)
+
+REGISTER_KERNEL(vector_bt,
+    .name = "VectorBt", .description = "vector, B transposed", .run = run_vector_bt,
+    .isa = "vector", .flags = KERNEL_TRANSPOSED_B, .dtypes = KERNEL_DTYPE_F64,
+    .shapes = KERNEL_SHAPE_RECT, .traffic = traffic_vector_bt, .blocking = blocking_vector_bt,
+    .order = 36)
 
 #endif // USE_VECTOR
@@ -0,0 +1,273 @@
+#include "perf_counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *counter_names[PERF_NUM_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+const char* perf_counter_name(PerfCounterId id) {
+    return (id >= 0 && id < PERF_NUM_COUNTERS) ? counter_names[id] : "unknown";
+}
+
+#ifdef __linux__
+
+#define CACHE_EVENT(cache, op, result) \
+    ((cache) | ((op) << 8) | ((result) << 16))
+
+static void counter_attr(PerfCounterId id, struct perf_event_attr *attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->disabled = 1;
+    attr->exclude_kernel = 1;   // Allowed at perf_event_paranoid <= 2
+    attr->exclude_hv = 1;
+    // Worker threads started while counting, as in the Parallel kernel, are
+    // counted too. Linux rejects group reads of inherited events, so every
+    // member is read on its own.
+    attr->inherit = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (id) {
+        case PERF_CYCLES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_EVENT(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                       PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_LLC_MISSES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PERF_DTLB_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                       PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_BRANCH_MISSES:
+            attr->type = PERF_TYPE_HARDWARE;
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            break;
+    }
+}
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd) {
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+int perf_counters_open(PerfCounters *pc) {
+    struct perf_event_attr attr;
+
+    memset(pc, 0, sizeof(*pc));
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        pc->fds[i] = -1;
+    }
+
+    // The cycle counter leads the group; without it nothing is measured
+    counter_attr(PERF_CYCLES, &attr);
+    pc->fds[PERF_CYCLES] = perf_event_open(&attr, -1);
+    if (pc->fds[PERF_CYCLES] < 0) {
+        snprintf(pc->error, sizeof(pc->error), "perf_event_open failed: %s", strerror(errno));
+        return -1;
+    }
+
+    // Members the PMU (or hypervisor) does not support are simply left out
+    for (int i = 1; i < PERF_NUM_COUNTERS; i++) {
+        counter_attr((PerfCounterId)i, &attr);
+        attr.disabled = 0;
+        pc->fds[i] = perf_event_open(&attr, pc->fds[PERF_CYCLES]);
+    }
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (pc->fds[i] >= 0) pc->open_mask |= 1u << i;
+    }
+    return (pc->open_mask & (1u << PERF_CYCLES)) ? 0 : -1;
+}
+
+void perf_counters_close(PerfCounters *pc) {
+    for (int i = PERF_NUM_COUNTERS - 1; i >= 0; i--) {
+        if (pc->fds[i] >= 0) close(pc->fds[i]);
+        pc->fds[i] = -1;
+    }
+    pc->open_mask = 0;
+}
+
+// Each read is value, time_enabled, time_running, including the counts
+// of inherited threads that have exited. PERF_EVENT_IOC_RESET leaves those
+// in place, so samples are the difference between reads at start and stop.
+static int counter_read(int fd, uint64_t *buf) {
+    return read(fd, buf, 3 * sizeof(uint64_t)) == (ssize_t)(3 * sizeof(uint64_t)) ? 0 : -1;
+}
+
+void perf_counters_start(PerfCounters *pc) {
+    if (!pc->open_mask) return;
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if ((pc->open_mask & (1u << i)) && counter_read(pc->fds[i], pc->start[i]) != 0) {
+            memset(pc->start[i], 0, sizeof(pc->start[i]));
+        }
+    }
+    ioctl(pc->fds[PERF_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample) {
+    uint64_t buf[3];
+
+    memset(sample, 0, sizeof(*sample));
+    if (!pc->open_mask) return;
+
+    ioctl(pc->fds[PERF_CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        if (!(pc->open_mask & (1u << i))) continue;
+        if (counter_read(pc->fds[i], buf) != 0) continue;
+
+        uint64_t value = buf[0] - pc->start[i][0];
+        uint64_t enabled = buf[1] - pc->start[i][1];
+        uint64_t running = buf[2] - pc->start[i][2];
+        if (running == 0) continue;     // Never got onto the PMU
+
+        sample->values[i] = (uint64_t)((double)value * (double)enabled / (double)running);
+        sample->valid_mask |= 1u << i;
+    }
+}
+
+#else
+
+int perf_counters_open(PerfCounters *pc) {
+    memset(pc, 0, sizeof(*pc));
+    snprintf(pc->error, sizeof(pc->error), "perf_event_open requires Linux");
+    return -1;
+}
+
+void perf_counters_close(PerfCounters *pc) {
+    pc->open_mask = 0;
+}
+
+void perf_counters_start(PerfCounters *pc) {
+    (void)pc;
+}
+
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample) {
+    (void)pc;
+    memset(sample, 0, sizeof(*sample));
+}
+
+#endif // __linux__
+
+// Recorder hooks
+static void recorder_before(void *user) {
+    PerfRecorder *rec = user;
+    perf_counters_start(rec->counters);
+}
+
+static void recorder_after(void *user, size_t iteration, double seconds) {
+    PerfRecorder *rec = user;
+    PerfSample sample;
+    (void)iteration;
+    (void)seconds;
+
+    perf_counters_stop(rec->counters, &sample);
+    if (rec->count == rec->capacity) {
+        size_t new_capacity = rec->capacity ? rec->capacity * 2 : 16;
+        PerfSample *samples = realloc(rec->samples, new_capacity * sizeof(PerfSample));
+        if (!samples) return;
+        rec->samples = samples;
+        rec->capacity = new_capacity;
+    }
+    rec->samples[rec->count++] = sample;
+}
+
+void perf_recorder_init(PerfRecorder *rec, PerfCounters *pc) {
+    memset(rec, 0, sizeof(*rec));
+    rec->counters = pc;
+    rec->hook.before_sample = recorder_before;
+    rec->hook.after_sample = recorder_after;
+    rec->hook.user = rec;
+}
+
+void perf_recorder_reset(PerfRecorder *rec) {
+    rec->count = 0;
+}
+
+void perf_recorder_free(PerfRecorder *rec) {
+    free(rec->samples);
+    rec->samples = NULL;
+    rec->count = 0;
+    rec->capacity = 0;
+}
+
+unsigned perf_samples_mean(const PerfSample *samples, size_t count, double *mean) {
+    unsigned mask = count ? ~0u : 0u;
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        mean[i] = 0.0;
+    }
+    for (size_t s = 0; s < count; s++) {
+        mask &= samples[s].valid_mask;
+        for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+            mean[i] += (double)samples[s].values[i];
+        }
+    }
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        mean[i] = count ? mean[i] / (double)count : 0.0;
+    }
+    return mask & ((1u << PERF_NUM_COUNTERS) - 1);
+}
+
+// Reporting
+void print_counters_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-14s %-6s %-13s %-13s %-13s %-13s\n",
+            "Method", "Size", "Cycles", "IPC", "L1D miss/FMA", "LLC miss/FMA",
+            "dTLB miss/FMA", "Br miss/FMA");
+    fprintf(out, "%-12s %-6s %-14s %-6s %-13s %-13s %-13s %-13s\n",
+            "------", "----", "------", "---", "------------", "------------",
+            "-------------", "-----------");
+}
+
+static void print_per_fma(FILE *out, unsigned mask, PerfCounterId id, double value, double fmas) {
+    if (mask & (1u << id)) {
+        fprintf(out, " %-13.5f", value / fmas);
+    } else {
+        fprintf(out, " %-13s", "n/a");
+    }
+}
+
+void print_counters_result(FILE *out, const char *method, size_t matrix_size,
+                           const PerfSample *samples, size_t count) {
+    double mean[PERF_NUM_COUNTERS];
+    unsigned mask = perf_samples_mean(samples, count, mean);
+    double fmas = (double)matrix_size * matrix_size * matrix_size;
+
+    if (!(mask & (1u << PERF_CYCLES))) {
+        fprintf(out, "%-12s %-6zu (counters not scheduled)\n", method, matrix_size);
+        return;
+    }
+
+    fprintf(out, "%-12s %-6zu %-14.0f", method, matrix_size, mean[PERF_CYCLES]);
+    if (mask & (1u << PERF_INSTRUCTIONS)) {
+        fprintf(out, " %-6.2f", mean[PERF_INSTRUCTIONS] / mean[PERF_CYCLES]);
+    } else {
+        fprintf(out, " %-6s", "n/a");
+    }
+    print_per_fma(out, mask, PERF_L1D_MISSES, mean[PERF_L1D_MISSES], fmas);
+    print_per_fma(out, mask, PERF_LLC_MISSES, mean[PERF_LLC_MISSES], fmas);
+    print_per_fma(out, mask, PERF_DTLB_MISSES, mean[PERF_DTLB_MISSES], fmas);
+    print_per_fma(out, mask, PERF_BRANCH_MISSES, mean[PERF_BRANCH_MISSES], fmas);
+    fprintf(out, "\n");
+}
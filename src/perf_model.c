@@ -0,0 +1,298 @@
+#include "perf_model.h"
+#include "config.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define MODEL_TIERS 3
+#define MODEL_MAX_PLAN_TILE 512
+#define MODEL_PLAN_STEP 8
+
+// Loads of one operand grouped by reuse distance: tier i holds the bytes
+// whose previous use was at least distance bytes of other data ago. Tiers
+// are nested, so a cache misses the bytes of the first tier it cannot hold.
+typedef struct {
+    double bytes;
+    double distance;
+} ModelTier;
+
+int model_machine_from_profile(ModelMachine *mm, const UarchProfile *profile) {
+    memset(mm, 0, sizeof(*mm));
+    if (profile->peak_gflops <= 0.0 || profile->bandwidth_gbs[ROOF_DRAM] <= 0.0) return -1;
+
+    mm->peak_gflops = profile->peak_gflops;
+    if (profile->clock_ghz > 0.0) mm->fma_latency_ns = profile->fma_latency / profile->clock_ghz;
+    if (profile->cache_levels > 0) mm->load_latency_ns = profile->cache_latency_ns[0];
+    memcpy(mm->bandwidth_gbs, profile->bandwidth_gbs, sizeof(mm->bandwidth_gbs));
+    for (int level = 0; level < UARCH_MAX_LEVELS; level++) {
+        mm->cache_bytes[level] = level < profile->cache_levels ? profile->cache_bytes[level] : 0;
+    }
+    return 0;
+}
+
+int model_machine_measure(ModelMachine *mm, double seconds_per_test) {
+    RoofMachine machine;
+
+    memset(mm, 0, sizeof(*mm));
+    if (roofline_measure(&machine, seconds_per_test) != 0) return -1;
+    mm->peak_gflops = machine.peak_gflops;
+    memcpy(mm->bandwidth_gbs, machine.bandwidth_gbs, sizeof(mm->bandwidth_gbs));
+    for (int level = 0; level < UARCH_MAX_LEVELS; level++) {
+        mm->cache_bytes[level] = get_cache_size(level + 1);
+    }
+    return 0;
+}
+
+// Prediction
+static double blocks(size_t n, size_t block) {
+    return ceil((double)n / (double)block);
+}
+
+static size_t clamp_size(size_t value, size_t limit) {
+    if (value == 0 || value > limit) return limit;
+    return value;
+}
+
+// A structure counts as resident when it fits in half the cache, as in the
+// roofline traffic models
+static double tier_misses(const ModelTier *tiers, size_t cache_bytes) {
+    for (int i = 0; i < MODEL_TIERS; i++) {
+        if (tiers[i].distance > (double)cache_bytes / 2.0) return tiers[i].bytes;
+    }
+    return 0.0;
+}
+
+static double level_seconds(double bytes, double gbs, double scale) {
+    return gbs > 0.0 ? bytes / (gbs * scale * 1e9) : 0.0;
+}
+
+// Each core works on ceil(m / threads) rows, so reuse distances use that
+// share of A and C. Rows of B are whole cache lines apart, so a B
+// micro-panel narrower than a line costs a line per row when it misses.
+// The MR x NR elements of C are the independent FMA chains: with fewer
+// than latency x throughput of them, FMA latency rather than peak FLOPS
+// bounds the arithmetic, plus a store and reload per step when C is not
+// kept in registers. Transfers between levels do not overlap each other,
+// as in the ECM model, but do overlap the arithmetic.
+void model_predict(const ModelMachine *mm, size_t m, size_t n, size_t k,
+                   const ModelBlocking *blocking, ModelPrediction *out) {
+    const double e = sizeof(double);
+    int threads = blocking->threads > 0 ? blocking->threads : 1;
+    size_t rows = (m + (size_t)threads - 1) / (size_t)threads;
+    size_t mc = clamp_size(blocking->mc, rows);
+    size_t kc = clamp_size(blocking->kc, k);
+    size_t nc = clamp_size(blocking->nc, n);
+    size_t mr = clamp_size(blocking->mr, mc);
+    size_t nr = clamp_size(blocking->nr, nc);
+    size_t kr = clamp_size(blocking->kr, kc);
+    double dm = (double)m, dn = (double)n, dk = (double)k, drows = (double)rows;
+    double row_bytes = nr * e < CACHE_LINE_SIZE ? CACHE_LINE_SIZE : nr * e;
+    double waste = row_bytes / (nr * e);
+
+    // A: each micro-panel is reloaded for every NR columns, and the whole
+    // block again for every NC panel of B
+    ModelTier a[MODEL_TIERS] = {
+        { e * dm * dk * blocks(n, nr), e * (mc * kc + kc * nr) },
+        { e * dm * dk * blocks(n, nc), e * (drows * dk + dk * nc + drows * nc) },
+        { e * dm * dk, HUGE_VAL }
+    };
+    // B: each micro-panel is reloaded for every MR rows, the panel for every
+    // MC block of A
+    ModelTier b[MODEL_TIERS] = {
+        { e * dk * dn * blocks(m, mr) * waste, kc * row_bytes + e * (mr * kc + mr * nr) },
+        { e * dk * dn * blocks(m, mc), e * (kc * nc + mc * kc) },
+        { e * dk * dn, HUGE_VAL }
+    };
+    // C: read and written every KR steps, and again for every KC panel
+    ModelTier c[MODEL_TIERS] = {
+        { 2.0 * e * dm * dn * blocks(k, kr), e * (mr * nr + kr * (mr + nr)) },
+        { 2.0 * e * dm * dn * blocks(k, kc), e * (drows * nc + drows * kc + kc * nc) },
+        { 2.0 * e * dm * dn, HUGE_VAL }
+    };
+    if (kr >= kc) c[0] = c[1];
+
+    memset(out, 0, sizeof(*out));
+
+    // L1 serves every load the register blocking issues
+    out->bytes[ROOF_L1] = a[0].bytes + b[0].bytes / waste + c[0].bytes;
+
+    // Each further level serves what the nearest cache in front of it misses
+    double missed = tier_misses(a, mm->cache_bytes[0]) + tier_misses(b, mm->cache_bytes[0]) +
+                    tier_misses(c, mm->cache_bytes[0]);
+    for (int level = ROOF_L2; level <= ROOF_L3; level++) {
+        size_t cache = mm->cache_bytes[level - ROOF_L1];
+        if (cache == 0) continue;
+        out->bytes[level] = missed;
+        missed = tier_misses(a, cache) + tier_misses(b, cache) + tier_misses(c, cache);
+    }
+    out->bytes[ROOF_DRAM] = missed;
+
+    double peak_seconds = 2.0 * dm * dn * dk / (mm->peak_gflops * threads * 1e9);
+    double step_ns = mm->fma_latency_ns + (kr == 1 ? mm->load_latency_ns : 0.0);
+    double chain_seconds = dm * dn * dk * step_ns * 1e-9 / ((double)(mr * nr) * threads);
+    out->compute_seconds = peak_seconds > chain_seconds ? peak_seconds : chain_seconds;
+    out->bound = peak_seconds >= chain_seconds ? MODEL_BOUND_COMPUTE : MODEL_BOUND_LATENCY;
+
+    double transfer_seconds = 0.0, costliest = 0.0;
+    int costliest_level = ROOF_L1;
+    for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+        double scale = level <= ROOF_L2 ? (double)threads : 1.0;
+        out->level_seconds[level] = level_seconds(out->bytes[level], mm->bandwidth_gbs[level], scale);
+        transfer_seconds += out->level_seconds[level];
+        if (out->level_seconds[level] > costliest) {
+            costliest = out->level_seconds[level];
+            costliest_level = level;
+        }
+    }
+    out->transfer_seconds = transfer_seconds;
+    out->seconds = out->compute_seconds;
+    if (transfer_seconds > out->compute_seconds) {
+        out->seconds = transfer_seconds;
+        out->bound = costliest_level;
+    }
+}
+
+// A compute- or latency-bound kernel is predicted the same time at every
+// tile, so ties go to the blocking that moves the least data
+static int model_faster(const ModelPrediction *a, const ModelPrediction *b) {
+    if (a->seconds != b->seconds) return a->seconds < b->seconds;
+    return a->transfer_seconds < b->transfer_seconds;
+}
+
+size_t model_plan_tile(const ModelMachine *mm, model_blocking_fn blocking, size_t n,
+                       int threads, ModelPrediction *out) {
+    size_t limit = n < MODEL_MAX_PLAN_TILE ? n : MODEL_MAX_PLAN_TILE;
+    size_t best_tile = limit < MODEL_PLAN_STEP ? limit : MODEL_PLAN_STEP;
+    ModelBlocking b;
+    ModelPrediction p;
+
+    blocking(n, best_tile, threads, &b);
+    model_predict(mm, n, n, n, &b, out);
+    for (size_t tile = best_tile + MODEL_PLAN_STEP; tile <= limit; tile += MODEL_PLAN_STEP) {
+        blocking(n, tile, threads, &b);
+        model_predict(mm, n, n, n, &b, &p);
+        if (model_faster(&p, out)) {
+            *out = p;
+            best_tile = tile;
+        }
+    }
+    return best_tile;
+}
+
+const char* model_bound_name(int bound) {
+    if (bound == MODEL_BOUND_COMPUTE) return "compute";
+    if (bound == MODEL_BOUND_LATENCY) return "latency";
+    return roofline_level_name((RoofLevel)bound);
+}
+
+// Validation
+void model_validation_init(ModelValidation *v, const ModelMachine *mm) {
+    memset(v, 0, sizeof(*v));
+    v->machine = mm;
+}
+
+int model_validation_add(ModelValidation *v, const char *kernel, model_blocking_fn blocking,
+                         size_t size, size_t tile, int threads, double measured_seconds) {
+    ModelBlocking b;
+
+    if (!blocking) return 0;
+    if (v->count == v->capacity) {
+        size_t new_capacity = v->capacity ? v->capacity * 2 : 16;
+        ModelPoint *points = realloc(v->points, new_capacity * sizeof(ModelPoint));
+        if (!points) return -1;
+        v->points = points;
+        v->capacity = new_capacity;
+    }
+
+    ModelPoint *p = &v->points[v->count++];
+    p->kernel = kernel;
+    p->blocking = blocking;
+    p->size = size;
+    p->tile = tile;
+    p->threads = threads;
+    p->measured = measured_seconds;
+    blocking(size, tile, threads, &b);
+    model_predict(v->machine, size, size, size, &b, &p->predicted);
+    return 0;
+}
+
+void model_validation_free(ModelValidation *v) {
+    free(v->points);
+    v->points = NULL;
+    v->count = 0;
+    v->capacity = 0;
+}
+
+static double relative_error(const ModelPoint *p) {
+    return (p->predicted.seconds - p->measured) / p->measured;
+}
+
+void print_model_validation(FILE *out, const ModelValidation *v) {
+    double sum = 0.0;
+
+    if (v->count == 0) {
+        fprintf(out, "\nNo modelled kernel was run\n");
+        return;
+    }
+
+    fprintf(out, "\nModel validation:\n");
+    fprintf(out, "%-12s %-6s %-5s %-7s %-10s %-10s %-9s %-8s\n",
+            "Method", "Size", "Tile", "Threads", "Pred (ms)", "Meas (ms)", "Error (%)", "Bound");
+    fprintf(out, "%-12s %-6s %-5s %-7s %-10s %-10s %-9s %-8s\n",
+            "------", "----", "----", "-------", "---------", "---------", "---------", "-----");
+    for (size_t i = 0; i < v->count; i++) {
+        const ModelPoint *p = &v->points[i];
+        double error = relative_error(p);
+        sum += fabs(error);
+        char tile_text[24];
+        if (p->tile) {
+            snprintf(tile_text, sizeof(tile_text), "%zu", p->tile);
+        } else {
+            snprintf(tile_text, sizeof(tile_text), "-");
+        }
+        fprintf(out, "%-12s %-6zu %-5s %-7d %-10.3f %-10.3f %-+9.1f %-8s\n",
+                p->kernel, p->size, tile_text, p->threads, p->predicted.seconds * 1000.0,
+                p->measured * 1000.0, error * 100.0, model_bound_name(p->predicted.bound));
+    }
+    fprintf(out, "\nMean absolute error: %.1f%% over %zu configurations\n",
+            100.0 * sum / (double)v->count, v->count);
+
+    // Loss is the measured slowdown of the model's pick over the fastest
+    // tile, among the tiles that were run. Untiled kernels have no choice.
+    fprintf(out, "\n%-12s %-6s %-7s %-10s %-10s %-8s %-8s %-10s\n",
+            "Method", "Size", "Threads", "Best tile", "Model pick", "Loss (%)", "Planned", "Plan (us)");
+    fprintf(out, "%-12s %-6s %-7s %-10s %-10s %-8s %-8s %-10s\n",
+            "------", "----", "-------", "---------", "----------", "--------", "-------", "---------");
+    for (size_t i = 0; i < v->count; i++) {
+        const ModelPoint *first = &v->points[i];
+        const ModelPoint *fastest = first, *picked = first;
+        int seen = 0;
+
+        for (size_t j = 0; j < i && !seen; j++) {
+            seen = v->points[j].kernel == first->kernel && v->points[j].size == first->size &&
+                   v->points[j].threads == first->threads;
+        }
+        if (seen || first->tile == 0) continue;
+        for (size_t j = i + 1; j < v->count; j++) {
+            const ModelPoint *p = &v->points[j];
+            if (p->kernel != first->kernel || p->size != first->size ||
+                p->threads != first->threads) {
+                continue;
+            }
+            if (p->measured < fastest->measured) fastest = p;
+            if (model_faster(&p->predicted, &picked->predicted)) picked = p;
+        }
+
+        ModelPrediction plan;
+        Timer timer;
+        timer_start(&timer);
+        size_t planned = model_plan_tile(v->machine, first->blocking, first->size,
+                                         first->threads, &plan);
+        timer_stop(&timer);
+        fprintf(out, "%-12s %-6zu %-7d %-10zu %-10zu %-8.1f %-8zu %-10.1f\n",
+                first->kernel, first->size, first->threads, fastest->tile, picked->tile,
+                100.0 * (picked->measured - fastest->measured) / fastest->measured,
+                planned, timer_elapsed_seconds(&timer) * 1e6);
+    }
+}
@@ -0,0 +1,127 @@
+#include "phase_timing.h"
+#include "trace.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+static const char *phase_names[PHASE_NUM_PHASES] = {
+    "zero", "pack_a", "pack_b", "micro_kernel", "epilogue", "sync"
+};
+
+// Shared by all threads; updated with relaxed atomics
+static PhaseTotals phase_totals;
+
+const char* phase_name(PhaseId phase) {
+    return (phase >= 0 && phase < PHASE_NUM_PHASES) ? phase_names[phase] : "unknown";
+}
+
+uint64_t phase_clock_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER now, frequency;
+    QueryPerformanceCounter(&now);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)now.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void phase_record(PhaseId phase, uint64_t begin_ns, uint64_t end_ns, uint64_t bytes) {
+    __atomic_fetch_add(&phase_totals.ns[phase], end_ns - begin_ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&phase_totals.bytes[phase], bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&phase_totals.calls[phase], 1, __ATOMIC_RELAXED);
+    if (TRACE_ENABLED()) {
+        trace_complete(phase_names[phase], "phase", begin_ns, end_ns, -1);
+    }
+}
+
+void phase_totals_reset(void) {
+    for (int i = 0; i < PHASE_NUM_PHASES; i++) {
+        __atomic_store_n(&phase_totals.ns[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&phase_totals.bytes[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&phase_totals.calls[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void phase_totals_snapshot(PhaseTotals *totals) {
+    for (int i = 0; i < PHASE_NUM_PHASES; i++) {
+        totals->ns[i] = __atomic_load_n(&phase_totals.ns[i], __ATOMIC_RELAXED);
+        totals->bytes[i] = __atomic_load_n(&phase_totals.bytes[i], __ATOMIC_RELAXED);
+        totals->calls[i] = __atomic_load_n(&phase_totals.calls[i], __ATOMIC_RELAXED);
+    }
+}
+
+// Recorder hooks
+static void recorder_before(void *user) {
+    (void)user;
+    phase_totals_reset();
+}
+
+static void recorder_after(void *user, size_t iteration, double seconds) {
+    PhaseRecorder *rec = user;
+    PhaseTotals sample;
+    (void)iteration;
+
+    phase_totals_snapshot(&sample);
+    for (int i = 0; i < PHASE_NUM_PHASES; i++) {
+        rec->sum.ns[i] += sample.ns[i];
+        rec->sum.bytes[i] += sample.bytes[i];
+        rec->sum.calls[i] += sample.calls[i];
+    }
+    rec->sample_seconds += seconds;
+    rec->samples++;
+}
+
+void phase_recorder_init(PhaseRecorder *rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->hook.before_sample = recorder_before;
+    rec->hook.after_sample = recorder_after;
+    rec->hook.user = rec;
+}
+
+void phase_recorder_reset(PhaseRecorder *rec) {
+    memset(&rec->sum, 0, sizeof(rec->sum));
+    rec->sample_seconds = 0.0;
+    rec->samples = 0;
+}
+
+// Reporting
+void print_phase_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-14s %-12s %-8s %-12s %-10s\n",
+            "Method", "Phase", "Time (ms)", "% Call", "Regions", "GB/s");
+    fprintf(out, "%-12s %-14s %-12s %-8s %-12s %-10s\n",
+            "------", "-----", "---------", "------", "-------", "----");
+}
+
+// Mean per call; time not covered by any region is shown as "other".
+// With several threads, phase time is summed over threads and can exceed
+// the wall time of the call.
+void print_phase_breakdown(FILE *out, const char *method, const PhaseRecorder *rec) {
+    if (rec->samples == 0) return;
+
+    double calls = (double)rec->samples;
+    double call_ms = rec->sample_seconds * 1000.0 / calls;
+    double attributed_ms = 0.0;
+
+    for (int i = 0; i < PHASE_NUM_PHASES; i++) {
+        if (rec->sum.calls[i] == 0) continue;
+
+        double ms = (double)rec->sum.ns[i] / 1e6 / calls;
+        double gbs = rec->sum.ns[i] ? (double)rec->sum.bytes[i] / (double)rec->sum.ns[i] : 0.0;
+        attributed_ms += ms;
+        fprintf(out, "%-12s %-14s %-12.3f %-8.1f %-12.0f %-10.2f\n",
+                method, phase_name((PhaseId)i), ms, 100.0 * ms / call_ms,
+                (double)rec->sum.calls[i] / calls, gbs);
+    }
+
+    double other_ms = call_ms - attributed_ms;
+    if (other_ms < 0.0) other_ms = 0.0;
+    fprintf(out, "%-12s %-14s %-12.3f %-8.1f %-12s %-10s\n",
+            method, "other", other_ms, 100.0 * other_ms / call_ms, "-", "-");
+}
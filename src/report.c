@@ -0,0 +1,206 @@
+#include "report.h"
+#include "utils.h"
+#include <string.h>
+
+// Compiler flags are injected by the Makefile; manual builds leave them unknown
+#ifndef BUILD_CFLAGS
+#define BUILD_CFLAGS "unknown"
+#endif
+
+#if defined(__clang__)
+#define BUILD_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#define BUILD_COMPILER "gcc " __VERSION__
+#else
+#define BUILD_COMPILER "unknown"
+#endif
+
+int report_parse_format(const char *name, ReportFormat *format) {
+    if (strcmp(name, "table") == 0) {
+        *format = REPORT_TABLE;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = REPORT_CSV;
+    } else if (strcmp(name, "json") == 0) {
+        *format = REPORT_JSON;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+const char* report_format_name(ReportFormat format) {
+    switch (format) {
+        case REPORT_CSV: return "csv";
+        case REPORT_JSON: return "json";
+        default: return "table";
+    }
+}
+
+void report_env_collect(ReportEnv *env) {
+    memset(env, 0, sizeof(*env));
+    get_cpu_model(env->cpu_model, sizeof(env->cpu_model));
+    env->isa = get_isa_string();
+    env->compiler = BUILD_COMPILER;
+    env->cflags = BUILD_CFLAGS;
+    env->processors = get_num_processors();
+    env->l1_cache = get_cache_size(1);
+    env->l2_cache = get_cache_size(2);
+    env->l3_cache = get_cache_size(3);
+}
+
+// Escaping helpers
+static void write_json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_csv_string(FILE *out, const char *s) {
+    if (strpbrk(s, ",\"\n") == NULL) {
+        fputs(s, out);
+        return;
+    }
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+// Writer
+void report_begin(Report *report, ReportFormat format, FILE *out, const BenchConfig *cfg) {
+    report->format = format;
+    report->out = out;
+    report->kernels_written = 0;
+    report_env_collect(&report->env);
+
+    if (format == REPORT_CSV) {
+        fprintf(out, "%s\n", REPORT_CSV_HEADER);
+    } else if (format == REPORT_JSON) {
+        const ReportEnv *env = &report->env;
+        fprintf(out, "{\n  \"environment\": {\n    \"cpu_model\": ");
+        write_json_string(out, env->cpu_model);
+        fprintf(out, ",\n    \"isa\": ");
+        write_json_string(out, env->isa);
+        fprintf(out, ",\n    \"compiler\": ");
+        write_json_string(out, env->compiler);
+        fprintf(out, ",\n    \"cflags\": ");
+        write_json_string(out, env->cflags);
+        fprintf(out, ",\n    \"processors\": %ld,\n", env->processors);
+        fprintf(out, "    \"l1_cache\": %zu,\n    \"l2_cache\": %zu,\n    \"l3_cache\": %zu\n  },\n",
+                env->l1_cache, env->l2_cache, env->l3_cache);
+        fprintf(out, "  \"config\": {\n");
+        fprintf(out, "    \"timer\": ");
+        write_json_string(out, timer_backend_name());
+        fprintf(out, ",\n    \"timer_tick_hz\": %.0f,\n", timer_tick_frequency());
+        fprintf(out, "    \"timer_overhead_ns\": %.1f,\n", timer_overhead_seconds() * 1e9);
+        fprintf(out, "    \"single_shot\": %s,\n", cfg->single_shot ? "true" : "false");
+        fprintf(out, "    \"warmup_iterations\": %d,\n", cfg->warmup_iterations);
+        fprintf(out, "    \"min_iterations\": %d,\n", cfg->min_iterations);
+        fprintf(out, "    \"max_iterations\": %d,\n", cfg->max_iterations);
+        fprintf(out, "    \"target_rel_ci\": %g,\n", cfg->target_rel_ci);
+        fprintf(out, "    \"time_budget_seconds\": %g\n  },\n", cfg->time_budget_seconds);
+        fprintf(out, "  \"results\": [");
+    }
+}
+
+void report_kernel(Report *report, const ReportRecord *record, const BenchResult *result) {
+    FILE *out = report->out;
+    const ReportEnv *env = &report->env;
+
+    if (report->format == REPORT_CSV) {
+        for (size_t i = 0; i < result->count; i++) {
+            double t = result->samples[i];
+            write_csv_string(out, record->kernel);
+            fprintf(out, ",%zu,%zu,%d,", record->size, record->tile, record->threads);
+            write_csv_string(out, env->isa);
+            fprintf(out, ",%zu,%.6f,%.4f,", i, t * 1000.0, calculate_gflops(record->size, t));
+            write_csv_string(out, env->cpu_model);
+            fputc(',', out);
+            write_csv_string(out, env->compiler);
+            fputc(',', out);
+            write_csv_string(out, env->cflags);
+            fprintf(out, ",%zu,%zu,%zu", env->l1_cache, env->l2_cache, env->l3_cache);
+            for (int c = 0; c < PERF_NUM_COUNTERS; c++) {
+                if (record->counters && (record->counters[i].valid_mask & (1u << c))) {
+                    fprintf(out, ",%llu", (unsigned long long)record->counters[i].values[c]);
+                } else {
+                    fputc(',', out);
+                }
+            }
+            if (record->energy_joules) {
+                fprintf(out, ",%.6f", record->energy_joules[i]);
+            } else {
+                fputc(',', out);
+            }
+            if (record->freq) {
+                const FreqSample *f = &record->freq[i];
+                fprintf(out, ",%.1f,%.1f,%d", f->mean_khz / 1e3, f->max_temp_c, f->stable);
+            } else {
+                fputs(",,,", out);
+            }
+            fputc('\n', out);
+        }
+    } else if (report->format == REPORT_JSON) {
+        const BenchStats *s = &result->stats;
+        fprintf(out, "%s\n    {\n      \"kernel\": ", report->kernels_written ? "," : "");
+        write_json_string(out, record->kernel);
+        fprintf(out, ",\n      \"size\": %zu,\n      \"tile\": %zu,\n      \"threads\": %d,\n",
+                record->size, record->tile, record->threads);
+        fprintf(out, "      \"isa\": ");
+        write_json_string(out, env->isa);
+        fprintf(out, ",\n      \"warmups\": %d,\n", result->warmups_run);
+        fprintf(out, "      \"first_call_ms\": %.6f,\n", result->first_call_seconds * 1000.0);
+        fprintf(out, "      \"stats\": {\"count\": %zu, \"min_ms\": %.6f, \"median_ms\": %.6f, "
+                     "\"mean_ms\": %.6f, \"p90_ms\": %.6f, \"max_ms\": %.6f, \"stddev_ms\": %.6f, "
+                     "\"cv\": %.6f, \"gflops\": %.4f},\n",
+                s->count, s->min * 1000.0, s->median * 1000.0, s->mean * 1000.0,
+                s->p90 * 1000.0, s->max * 1000.0, s->stddev * 1000.0, s->cv,
+                calculate_gflops(record->size, s->median));
+        fprintf(out, "      \"samples\": [");
+        for (size_t i = 0; i < result->count; i++) {
+            double t = result->samples[i];
+            fprintf(out, "%s\n        {\"iteration\": %zu, \"time_ms\": %.6f, \"gflops\": %.4f",
+                    i ? "," : "", i, t * 1000.0, calculate_gflops(record->size, t));
+            if (record->counters) {
+                for (int c = 0; c < PERF_NUM_COUNTERS; c++) {
+                    if (record->counters[i].valid_mask & (1u << c)) {
+                        fprintf(out, ", \"%s\": %llu", perf_counter_name((PerfCounterId)c),
+                                (unsigned long long)record->counters[i].values[c]);
+                    }
+                }
+            }
+            if (record->energy_joules) {
+                fprintf(out, ", \"energy_j\": %.6f", record->energy_joules[i]);
+            }
+            if (record->freq) {
+                const FreqSample *f = &record->freq[i];
+                fprintf(out, ", \"freq_mhz\": %.1f, \"max_temp_c\": %.1f, \"stable\": %s",
+                        f->mean_khz / 1e3, f->max_temp_c, f->stable ? "true" : "false");
+            }
+            fputc('}', out);
+        }
+        fprintf(out, "\n      ]\n    }");
+    }
+
+    report->kernels_written++;
+    fflush(out);
+}
+
+void report_end(Report *report) {
+    if (report->format == REPORT_JSON) {
+        fprintf(report->out, "\n  ]\n}\n");
+    }
+    fflush(report->out);
+}
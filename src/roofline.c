@@ -0,0 +1,268 @@
+#include "roofline.h"
+#include "config.h"
+#include "matrix.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Independent accumulator chains in the peak test; enough to cover
+// FMA latency x issue width on current cores once vectorized
+#define ROOF_CHAINS 64
+#define ROOF_PEAK_ITERATIONS (1 << 18)
+
+// Each timed bandwidth chunk streams at least this many bytes
+#define ROOF_MIN_CHUNK_BYTES (8 * 1024 * 1024)
+#define ROOF_MAX_STREAM_BYTES ((size_t)512 * 1024 * 1024)
+#define ROOF_MIN_DRAM_BYTES ((size_t)64 * 1024 * 1024)
+
+static volatile double roof_sink;
+
+// Measurement
+static void peak_chunk(double *acc, size_t iterations) {
+    const double m = 0.9999999;
+    const double a = 1e-7;
+
+    for (size_t it = 0; it < iterations; it++) {
+        for (size_t j = 0; j < ROOF_CHAINS; j++) {
+            acc[j] = acc[j] * m + a;
+        }
+    }
+}
+
+double roofline_measure_peak(double seconds) {
+    double acc[ROOF_CHAINS];
+    double best = 0.0;
+    Timer total, timer;
+
+    for (size_t j = 0; j < ROOF_CHAINS; j++) {
+        acc[j] = 1.0 + (double)j * 1e-3;
+    }
+
+    timer_start(&total);
+    do {
+        timer_start(&timer);
+        peak_chunk(acc, ROOF_PEAK_ITERATIONS);
+        timer_stop(&timer);
+
+        double flops = 2.0 * ROOF_CHAINS * (double)ROOF_PEAK_ITERATIONS;
+        double gflops = flops / (timer_elapsed_seconds(&timer) * 1e9);
+        if (gflops > best) best = gflops;
+        timer_stop(&total);
+    } while (timer_elapsed_seconds(&total) < seconds);
+
+    double sum = 0.0;
+    for (size_t j = 0; j < ROOF_CHAINS; j++) {
+        sum += acc[j];
+    }
+    roof_sink = sum;
+    return best;
+}
+
+// STREAM triad over three arrays totalling bytes; best rate in GB/s.
+// Bytes are counted STREAM-style (two reads and one write per element).
+double roofline_measure_bandwidth(size_t bytes, double seconds) {
+    size_t n = bytes / (3 * sizeof(double));
+    if (n < 64) n = 64;
+
+    double *a = aligned_malloc(n * sizeof(double), CACHE_LINE_SIZE);
+    double *b = aligned_malloc(n * sizeof(double), CACHE_LINE_SIZE);
+    double *c = aligned_malloc(n * sizeof(double), CACHE_LINE_SIZE);
+    if (!a || !b || !c) {
+        aligned_free(a);
+        aligned_free(b);
+        aligned_free(c);
+        return 0.0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    size_t pass_bytes = 3 * n * sizeof(double);
+    size_t reps = ROOF_MIN_CHUNK_BYTES / pass_bytes;
+    if (reps < 1) reps = 1;
+
+    const double scalar = 3.0;
+    double best = 0.0;
+    Timer total, timer;
+
+    timer_start(&total);
+    do {
+        timer_start(&timer);
+        for (size_t r = 0; r < reps; r++) {
+            for (size_t i = 0; i < n; i++) {
+                a[i] = b[i] + scalar * c[i];
+            }
+            roof_sink = a[r % n];
+        }
+        timer_stop(&timer);
+
+        double gbs = (double)(pass_bytes * reps) / (timer_elapsed_seconds(&timer) * 1e9);
+        if (gbs > best) best = gbs;
+        timer_stop(&total);
+    } while (timer_elapsed_seconds(&total) < seconds);
+
+    aligned_free(a);
+    aligned_free(b);
+    aligned_free(c);
+    return best;
+}
+
+int roofline_measure(RoofMachine *machine, double seconds_per_test) {
+    size_t l1 = get_cache_size(1);
+    size_t l2 = get_cache_size(2);
+    size_t l3 = get_cache_size(3);
+    size_t dram = 4 * (l3 > l2 ? l3 : l2);
+
+    if (dram < ROOF_MIN_DRAM_BYTES) dram = ROOF_MIN_DRAM_BYTES;
+    if (dram > ROOF_MAX_STREAM_BYTES) dram = ROOF_MAX_STREAM_BYTES;
+
+    // Half of each level leaves room for the stack, code and prefetch slack
+    machine->working_set[ROOF_L1] = l1 / 2;
+    machine->working_set[ROOF_L2] = l2 / 2;
+    machine->working_set[ROOF_L3] = l3 / 2;
+    machine->working_set[ROOF_DRAM] = dram;
+
+    machine->peak_gflops = roofline_measure_peak(seconds_per_test);
+    for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+        machine->bandwidth_gbs[level] =
+            roofline_measure_bandwidth(machine->working_set[level], seconds_per_test);
+        if (machine->bandwidth_gbs[level] <= 0.0) return -1;
+    }
+    return 0;
+}
+
+// Traffic models
+//
+// Bytes moved between a cache of cache_bytes and the next level, for square
+// n x n operands of doubles. A structure counts as resident when it fits in
+// half the cache. C is read once (write-allocate) and written once.
+static int fits(double bytes, size_t cache_bytes) {
+    return bytes <= (double)cache_bytes / 2.0;
+}
+
+static double compulsory_bytes(double n) {
+    return 4.0 * n * n * sizeof(double);
+}
+
+// ijk: B is walked down columns for every row of A
+double roofline_traffic_naive(size_t n, size_t tile, size_t cache_bytes) {
+    double dn = (double)n;
+    double b_bytes;
+    (void)tile;
+
+    if (fits(3.0 * dn * dn * sizeof(double), cache_bytes)) {
+        return compulsory_bytes(dn);
+    }
+    if (fits(dn * dn * sizeof(double), cache_bytes)) {
+        b_bytes = dn * dn * sizeof(double);
+    } else if (fits(dn * CACHE_LINE_SIZE, cache_bytes)) {
+        // A column of lines survives until the next 7 columns reuse it
+        b_bytes = dn * dn * dn * sizeof(double);
+    } else {
+        // Every element of the column costs a full line
+        b_bytes = dn * dn * dn * CACHE_LINE_SIZE;
+    }
+    return dn * dn * sizeof(double) + b_bytes + 2.0 * dn * dn * sizeof(double);
+}
+
+// ii/jj/kk tiles: one A and B tile per tile triple, C tile once per (ii, jj)
+double roofline_traffic_tiled(size_t n, size_t tile, size_t cache_bytes) {
+    double dn = (double)n;
+    double t = (double)(tile < n ? tile : n);
+
+    if (fits(3.0 * dn * dn * sizeof(double), cache_bytes)) {
+        return compulsory_bytes(dn);
+    }
+    if (!fits(3.0 * t * t * sizeof(double), cache_bytes)) {
+        return roofline_traffic_naive(n, tile, cache_bytes);
+    }
+
+    double blocks = dn / t;
+    double ab = blocks * blocks * blocks * 2.0 * t * t * sizeof(double);
+    double c = blocks * blocks * 2.0 * t * t * sizeof(double);
+    return ab + c;
+}
+
+// ikj: row k of B is streamed for every row of A, row i of C stays resident
+double roofline_traffic_vector(size_t n, size_t tile, size_t cache_bytes) {
+    double dn = (double)n;
+    (void)tile;
+
+    if (fits(dn * dn * sizeof(double), cache_bytes)) {
+        return compulsory_bytes(dn);
+    }
+    return dn * dn * sizeof(double) + dn * dn * dn * sizeof(double) +
+           2.0 * dn * dn * sizeof(double);
+}
+
+void roofline_point(const RoofMachine *machine, const char *kernel, size_t n, size_t tile,
+                    roof_traffic_fn traffic, double measured_seconds, RoofPoint *point) {
+    size_t llc = get_cache_size(3);
+    if (llc == 0) llc = get_cache_size(2);
+
+    point->kernel = kernel;
+    point->size = n;
+    point->tile = tile;
+    point->flops = 2.0 * (double)n * (double)n * (double)n;
+    point->dram_bytes = traffic(n, tile, llc);
+    point->intensity = point->flops / point->dram_bytes;
+    point->gflops = point->flops / (measured_seconds * 1e9);
+
+    double memory_roof = point->intensity * machine->bandwidth_gbs[ROOF_DRAM];
+    point->memory_bound = memory_roof < machine->peak_gflops;
+    point->roof_gflops = point->memory_bound ? memory_roof : machine->peak_gflops;
+}
+
+const char* roofline_level_name(RoofLevel level) {
+    static const char *names[ROOF_NUM_LEVELS] = { "L1", "L2", "L3", "DRAM" };
+    return (level >= 0 && level < ROOF_NUM_LEVELS) ? names[level] : "unknown";
+}
+
+// Reporting
+void print_roofline_machine(FILE *out, const RoofMachine *machine) {
+    fprintf(out, "Measured ceilings:\n");
+    fprintf(out, "  Peak FMA throughput: %.2f GFLOPS\n", machine->peak_gflops);
+    for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+        double ridge = machine->peak_gflops / machine->bandwidth_gbs[level];
+        fprintf(out, "  %-4s bandwidth: %8.2f GB/s  (working set %8zu KB, ridge %.2f FLOP/byte)\n",
+                roofline_level_name((RoofLevel)level), machine->bandwidth_gbs[level],
+                machine->working_set[level] / 1024, ridge);
+    }
+}
+
+void print_roofline_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-5s %-12s %-10s %-10s %-9s %-8s\n",
+            "Method", "Size", "Tile", "FLOP/byte", "GFLOPS", "Roof", "% Roof", "Bound");
+    fprintf(out, "%-12s %-6s %-5s %-12s %-10s %-10s %-9s %-8s\n",
+            "------", "----", "----", "---------", "------", "----", "------", "-----");
+}
+
+void print_roofline_point(FILE *out, const RoofPoint *p) {
+    fprintf(out, "%-12s %-6zu %-5zu %-12.3f %-10.2f %-10.2f %-9.1f %-8s\n",
+            p->kernel, p->size, p->tile, p->intensity, p->gflops, p->roof_gflops,
+            100.0 * p->gflops / p->roof_gflops, p->memory_bound ? "memory" : "compute");
+}
+
+// Plot-ready CSV: roof rows give the ceilings, kernel rows the measured points
+void write_roofline_csv(FILE *out, const RoofMachine *machine,
+                        const RoofPoint *points, size_t count) {
+    fprintf(out, "type,name,size,tile,arith_intensity,gflops,bandwidth_gbs,peak_gflops,roof_gflops,pct_of_roof,bound\n");
+    for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+        fprintf(out, "roof,%s,,,%.6f,,%.4f,%.4f,,,\n",
+                roofline_level_name((RoofLevel)level),
+                machine->peak_gflops / machine->bandwidth_gbs[level],
+                machine->bandwidth_gbs[level], machine->peak_gflops);
+    }
+    for (size_t i = 0; i < count; i++) {
+        const RoofPoint *p = &points[i];
+        fprintf(out, "kernel,%s,%zu,%zu,%.6f,%.4f,%.4f,%.4f,%.4f,%.2f,%s\n",
+                p->kernel, p->size, p->tile, p->intensity, p->gflops,
+                machine->bandwidth_gbs[ROOF_DRAM], machine->peak_gflops,
+                p->roof_gflops, 100.0 * p->gflops / p->roof_gflops,
+                p->memory_bound ? "memory" : "compute");
+    }
+}
@@ -0,0 +1,182 @@
+#include "scaling.h"
+#include "config.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+
+#define SCALING_MIN_STREAM_BYTES ((size_t)64 * 1024 * 1024)
+#define SCALING_MAX_STREAM_BYTES ((size_t)512 * 1024 * 1024)
+#define SCALING_STREAM_REPS 4
+
+static volatile double scaling_sink;
+
+size_t scaling_weak_size(size_t base, int threads) {
+    return (size_t)(cbrt((double)threads) * (double)base + 0.5);
+}
+
+int scaling_stream_init(ScalingStream *stream, size_t bytes) {
+    if (bytes == 0) {
+        size_t l2 = get_cache_size(2);
+        size_t l3 = get_cache_size(3);
+        bytes = 4 * (l3 > l2 ? l3 : l2);
+    }
+    if (bytes < SCALING_MIN_STREAM_BYTES) bytes = SCALING_MIN_STREAM_BYTES;
+    if (bytes > SCALING_MAX_STREAM_BYTES) bytes = SCALING_MAX_STREAM_BYTES;
+
+    stream->n = bytes / (3 * sizeof(double));
+    stream->a = aligned_malloc(stream->n * sizeof(double), CACHE_LINE_SIZE);
+    stream->b = aligned_malloc(stream->n * sizeof(double), CACHE_LINE_SIZE);
+    stream->c = aligned_malloc(stream->n * sizeof(double), CACHE_LINE_SIZE);
+    if (!stream->a || !stream->b || !stream->c) {
+        scaling_stream_free(stream);
+        return -1;
+    }
+    for (size_t i = 0; i < stream->n; i++) {
+        stream->a[i] = 0.0;
+        stream->b[i] = 1.0;
+        stream->c[i] = 2.0;
+    }
+    return 0;
+}
+
+void scaling_stream_free(ScalingStream *stream) {
+    aligned_free(stream->a);
+    aligned_free(stream->b);
+    aligned_free(stream->c);
+    stream->a = stream->b = stream->c = NULL;
+    stream->n = 0;
+}
+
+typedef struct {
+    ScalingStream *stream;
+    size_t begin;
+    size_t end;
+} TriadSlice;
+
+static void* triad_worker(void *arg) {
+    TriadSlice *slice = arg;
+    double *a = slice->stream->a;
+    const double *b = slice->stream->b;
+    const double *c = slice->stream->c;
+    const double scalar = 3.0;
+
+    for (int r = 0; r < SCALING_STREAM_REPS; r++) {
+        for (size_t i = slice->begin; i < slice->end; i++) {
+            a[i] = b[i] + scalar * c[i];
+        }
+    }
+    return NULL;
+}
+
+// Each thread streams its own slice; the rate counts thread start-up, which
+// is small against hundreds of megabytes per round
+double scaling_stream_measure(ScalingStream *stream, int threads, double seconds) {
+    TriadSlice slices[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    double best = 0.0;
+    Timer total, timer;
+
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    for (int t = 0; t < threads; t++) {
+        slices[t].stream = stream;
+        slices[t].begin = stream->n * (size_t)t / (size_t)threads;
+        slices[t].end = stream->n * (size_t)(t + 1) / (size_t)threads;
+    }
+
+    timer_start(&total);
+    do {
+        int started = 0;
+
+        timer_start(&timer);
+        for (int t = 1; t < threads; t++) {
+            if (pthread_create(&ids[t], NULL, triad_worker, &slices[t]) != 0) break;
+            started = t;
+        }
+        triad_worker(&slices[0]);
+        for (int t = 1; t <= started; t++) {
+            pthread_join(ids[t], NULL);
+        }
+        timer_stop(&timer);
+
+        // Slices that failed to start were not streamed
+        double bytes = 3.0 * sizeof(double) * SCALING_STREAM_REPS *
+                       (double)(slices[started].end);
+        double gbs = bytes / (timer_elapsed_seconds(&timer) * 1e9);
+        if (gbs > best) best = gbs;
+        timer_stop(&total);
+    } while (timer_elapsed_seconds(&total) < seconds);
+
+    scaling_sink = stream->a[stream->n / 2];
+    return best;
+}
+
+void scaling_finish(ScalingPoint *points, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const ScalingPoint *base = NULL;
+
+        for (size_t j = 0; j < count && !base; j++) {
+            if (points[j].mode == points[i].mode && points[j].threads == 1) base = &points[j];
+        }
+        if (!base || points[i].seconds <= 0.0) {
+            points[i].speedup = points[i].efficiency = 0.0;
+            continue;
+        }
+        if (points[i].mode == SCALING_STRONG) {
+            points[i].speedup = base->seconds / points[i].seconds;
+        } else {
+            points[i].speedup = points[i].gflops / base->gflops;
+        }
+        points[i].efficiency = points[i].speedup / points[i].threads;
+    }
+}
+
+int scaling_saturation(const ScalingPoint *points, size_t count, ScalingMode mode,
+                       double fraction) {
+    double best = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (points[i].mode == mode && points[i].stream_gbs > best) best = points[i].stream_gbs;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (points[i].mode == mode && best > 0.0 && points[i].stream_gbs >= fraction * best) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const char* scaling_mode_name(ScalingMode mode) {
+    return mode == SCALING_WEAK ? "weak" : "strong";
+}
+
+// Reporting
+void print_scaling_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-7s %-7s %-6s %-10s %-8s %-8s %-7s %-11s %-11s\n",
+            "Mode", "Threads", "Size", "Med (ms)", "GFLOPS", "Speedup", "Eff (%)",
+            "Kern GB/s", "Triad GB/s");
+    fprintf(out, "%-7s %-7s %-6s %-10s %-8s %-8s %-7s %-11s %-11s\n",
+            "----", "-------", "----", "--------", "------", "-------", "-------",
+            "---------", "----------");
+}
+
+void print_scaling_point(FILE *out, const ScalingPoint *point) {
+    fprintf(out, "%-7s %-7d %-6zu %-10.3f %-8.2f %-8.2f %-7.1f %-11.2f %-11.2f\n",
+            scaling_mode_name(point->mode), point->threads, point->size,
+            point->seconds * 1000.0, point->gflops, point->speedup,
+            point->efficiency * 100.0, point->kernel_gbs, point->stream_gbs);
+}
+
+void write_scaling_csv(FILE *out, const ScalingPoint *points, size_t count) {
+    fprintf(out, "mode,kernel,threads,size,tile,median_ms,gflops,speedup,efficiency,"
+                 "kernel_gbs,stream_gbs\n");
+    for (size_t i = 0; i < count; i++) {
+        const ScalingPoint *p = &points[i];
+        fprintf(out, "%s,%s,%d,%zu,%zu,%.6f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                scaling_mode_name(p->mode), p->kernel, p->threads, p->size, p->tile,
+                p->seconds * 1000.0, p->gflops, p->speedup, p->efficiency,
+                p->kernel_gbs, p->stream_gbs);
+    }
+}
@@ -0,0 +1,165 @@
+#include "sweep.h"
+#include "config.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+void sweep_spec_init(SweepSpec *spec) {
+    memset(spec, 0, sizeof(*spec));
+}
+
+static int parse_count(const char *text, size_t len, size_t *value) {
+    char buf[32];
+    char *end;
+
+    if (len == 0 || len >= sizeof(buf)) return -1;
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    unsigned long long v = strtoull(buf, &end, 10);
+    if (*end != '\0' || v == 0) return -1;
+    *value = (size_t)v;
+    return 0;
+}
+
+// One list element: N or START:END:STEP
+static int parse_range(SweepSpec *spec, const char *text, size_t len,
+                       size_t *values, size_t *count) {
+    size_t start, end, step = 1;
+    const char *colon = memchr(text, ':', len);
+
+    if (!colon) {
+        if (parse_count(text, len, &start) != 0) goto invalid;
+        end = start;
+    } else {
+        const char *colon2 = memchr(colon + 1, ':', len - (size_t)(colon + 1 - text));
+        size_t end_len = (colon2 ? (size_t)(colon2 - colon) : len - (size_t)(colon - text)) - 1;
+
+        if (parse_count(text, (size_t)(colon - text), &start) != 0 ||
+            parse_count(colon + 1, end_len, &end) != 0 ||
+            (colon2 && parse_count(colon2 + 1, len - (size_t)(colon2 + 1 - text), &step) != 0) ||
+            end < start) {
+            goto invalid;
+        }
+    }
+
+    for (size_t v = start; v <= end; v += step) {
+        if (*count == SWEEP_MAX_VALUES) {
+            snprintf(spec->error, sizeof(spec->error), "more than %d values in one list", SWEEP_MAX_VALUES);
+            return -1;
+        }
+        values[(*count)++] = v;
+    }
+    return 0;
+
+invalid:
+    snprintf(spec->error, sizeof(spec->error), "invalid value or range '%.*s'", (int)len, text);
+    return -1;
+}
+
+static int parse_item(SweepSpec *spec, const char *item, size_t len) {
+    const char *eq = memchr(item, '=', len);
+    size_t key_len = eq ? (size_t)(eq - item) : 0;
+    const char *list = eq + 1;
+    const char *list_end = item + len;
+
+    if (!eq || list == list_end) {
+        snprintf(spec->error, sizeof(spec->error), "expected key=values, got '%.*s'", (int)len, item);
+        return -1;
+    }
+
+    while (list < list_end) {
+        const char *comma = memchr(list, ',', (size_t)(list_end - list));
+        size_t elem_len = (size_t)((comma ? comma : list_end) - list);
+
+        if (key_len == 5 && strncmp(item, "sizes", 5) == 0) {
+            if (parse_range(spec, list, elem_len, spec->sizes, &spec->num_sizes) != 0) return -1;
+        } else if (key_len == 5 && strncmp(item, "tiles", 5) == 0) {
+            if (parse_range(spec, list, elem_len, spec->tiles, &spec->num_tiles) != 0) return -1;
+        } else if (key_len == 7 && strncmp(item, "threads", 7) == 0) {
+            size_t values[SWEEP_MAX_VALUES];
+            size_t count = 0;
+            if (parse_range(spec, list, elem_len, values, &count) != 0) return -1;
+            for (size_t i = 0; i < count; i++) {
+                if (values[i] > MAX_THREADS || spec->num_threads == SWEEP_MAX_VALUES) {
+                    snprintf(spec->error, sizeof(spec->error),
+                             "thread counts must be between 1 and %d", MAX_THREADS);
+                    return -1;
+                }
+                spec->threads[spec->num_threads++] = (int)values[i];
+            }
+        } else if (key_len == 7 && strncmp(item, "kernels", 7) == 0) {
+            size_t used = strlen(spec->kernels);
+            if (elem_len == 0 || used + elem_len + 2 > sizeof(spec->kernels)) {
+                snprintf(spec->error, sizeof(spec->error), "invalid kernel list");
+                return -1;
+            }
+            snprintf(spec->kernels + used, sizeof(spec->kernels) - used, "%s%.*s",
+                     used ? "," : "", (int)elem_len, list);
+        } else {
+            snprintf(spec->error, sizeof(spec->error),
+                     "unknown key '%.*s' (expected sizes, tiles, threads or kernels)", (int)key_len, item);
+            return -1;
+        }
+        list += elem_len + 1;
+    }
+    return 0;
+}
+
+int sweep_parse(SweepSpec *spec, const char *text) {
+    while (*text) {
+        size_t len;
+
+        while (isspace((unsigned char)*text)) text++;
+        len = strcspn(text, " \t\n");
+        if (len == 0) break;
+        if (parse_item(spec, text, len) != 0) return -1;
+        text += len;
+    }
+    return 0;
+}
+
+// Unknown keys still count, so that they are reported rather than taken
+// for the matrix size
+int sweep_is_item(const char *arg) {
+    return arg[0] != '-' && strchr(arg, '=') != NULL;
+}
+
+void sweep_spec_defaults(SweepSpec *spec, size_t size, size_t tile, int threads) {
+    if (spec->num_sizes == 0) spec->sizes[spec->num_sizes++] = size;
+    if (spec->num_tiles == 0) spec->tiles[spec->num_tiles++] = tile;
+    if (spec->num_threads == 0) spec->threads[spec->num_threads++] = threads;
+}
+
+size_t sweep_max_size(const SweepSpec *spec) {
+    size_t max = 0;
+    for (size_t i = 0; i < spec->num_sizes; i++) {
+        if (spec->sizes[i] > max) max = spec->sizes[i];
+    }
+    return max;
+}
+
+// Reporting
+void print_sweep_header(FILE *out) {
+    fprintf(out, "\n");
+    fprintf(out, "%-12s %-6s %-5s %-7s %-10s %-7s %-5s %-8s %-6s\n",
+            "Method", "Size", "Tile", "Threads", "Med (ms)", "CV (%)", "N", "GFLOPS", "Verify");
+    fprintf(out, "%-12s %-6s %-5s %-7s %-10s %-7s %-5s %-8s %-6s\n",
+            "------", "----", "----", "-------", "--------", "------", "-", "------", "------");
+}
+
+void print_sweep_result(FILE *out, const char *kernel, size_t size, size_t tile,
+                        int threads, const BenchResult *result, int verified) {
+    const BenchStats *s = &result->stats;
+    char tile_text[24];
+
+    if (tile) {
+        snprintf(tile_text, sizeof(tile_text), "%zu", tile);
+    } else {
+        snprintf(tile_text, sizeof(tile_text), "-");
+    }
+    fprintf(out, "%-12s %-6zu %-5s %-7d %-10.3f %-7.2f %-5zu %-8.2f %-6s\n",
+            kernel, size, tile_text, threads, s->median * 1000.0, s->cv * 100.0, s->count,
+            calculate_gflops(size, s->median),
+            verified < 0 ? "-" : verified ? "ok" : "FAIL");
+}
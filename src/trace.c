@@ -0,0 +1,130 @@
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Single-producer ring; only the thread holding its trace id writes to it
+typedef struct {
+    TraceEvent events[TRACE_RING_EVENTS];
+    uint64_t written;       // Total events recorded, including overwritten ones
+} TraceRing;
+
+int trace_active = 0;
+
+static TraceRing *trace_rings[MAX_THREADS];
+static uint64_t trace_origin_ns;
+static char *trace_path;
+static __thread int trace_tid;
+
+void trace_set_thread(int tid) {
+    trace_tid = (tid >= 0 && tid < MAX_THREADS) ? tid : MAX_THREADS - 1;
+}
+
+void trace_complete(const char *name, const char *category,
+                    uint64_t begin_ns, uint64_t end_ns, long arg) {
+    TraceRing *ring = __atomic_load_n(&trace_rings[trace_tid], __ATOMIC_ACQUIRE);
+
+    if (!ring) {
+        ring = calloc(1, sizeof(TraceRing));
+        if (!ring) return;
+        __atomic_store_n(&trace_rings[trace_tid], ring, __ATOMIC_RELEASE);
+    }
+
+    TraceEvent *ev = &ring->events[ring->written % TRACE_RING_EVENTS];
+    ev->name = name;
+    ev->category = category;
+    ev->begin_ns = begin_ns;
+    ev->end_ns = end_ns;
+    ev->arg = arg;
+    __atomic_store_n(&ring->written, ring->written + 1, __ATOMIC_RELEASE);
+}
+
+// Chrome trace JSON: timestamps in microseconds from trace_start()
+int trace_write(FILE *out) {
+    uint64_t dropped = 0;
+    int first = 1;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    for (int t = 0; t < MAX_THREADS; t++) {
+        TraceRing *ring = __atomic_load_n(&trace_rings[t], __ATOMIC_ACQUIRE);
+        if (!ring) continue;
+
+        uint64_t written = __atomic_load_n(&ring->written, __ATOMIC_ACQUIRE);
+        uint64_t start = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+        dropped += start;
+
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":\"%s %d\"}}", first ? "" : ",\n", t,
+                t == 0 ? "main" : "worker", t);
+        first = 0;
+
+        for (uint64_t i = start; i < written; i++) {
+            const TraceEvent *ev = &ring->events[i % TRACE_RING_EVENTS];
+            double ts = (double)(int64_t)(ev->begin_ns - trace_origin_ns) / 1e3;
+            double dur = (double)(ev->end_ns - ev->begin_ns) / 1e3;
+
+            fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f", ev->name, ev->category, t, ts, dur);
+            if (ev->arg >= 0) {
+                fprintf(out, ",\"args\":{\"index\":%ld}", ev->arg);
+            }
+            fprintf(out, "}");
+        }
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%llu}}\n",
+            (unsigned long long)dropped);
+    return ferror(out) ? -1 : 0;
+}
+
+static void trace_write_at_exit(void) {
+    FILE *out;
+
+    trace_active = 0;
+    out = fopen(trace_path, "w");
+    if (!out || trace_write(out) != 0) {
+        fprintf(stderr, "Error: Cannot write trace file '%s'\n", trace_path);
+    }
+    if (out) fclose(out);
+
+    for (int t = 0; t < MAX_THREADS; t++) {
+        free(trace_rings[t]);
+        trace_rings[t] = NULL;
+    }
+    free(trace_path);
+}
+
+int trace_start(const char *path) {
+    trace_path = malloc(strlen(path) + 1);
+    if (!trace_path) return -1;
+    strcpy(trace_path, path);
+
+    if (atexit(trace_write_at_exit) != 0) {
+        free(trace_path);
+        trace_path = NULL;
+        return -1;
+    }
+    trace_origin_ns = phase_clock_ns();
+    trace_active = 1;
+    return 0;
+}
+
+// Sample hook
+static void sample_before(void *user) {
+    TraceSampleHook *th = user;
+    if (TRACE_ENABLED()) th->begin_ns = phase_clock_ns();
+}
+
+static void sample_after(void *user, size_t iteration, double seconds) {
+    TraceSampleHook *th = user;
+    (void)seconds;
+    if (TRACE_ENABLED()) {
+        trace_complete(th->name, "sample", th->begin_ns, phase_clock_ns(), (long)iteration);
+    }
+}
+
+void trace_sample_hook_init(TraceSampleHook *th) {
+    memset(th, 0, sizeof(*th));
+    th->name = "kernel";
+    th->hook.before_sample = sample_before;
+    th->hook.after_sample = sample_after;
+    th->hook.user = th;
+}
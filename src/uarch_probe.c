@@ -0,0 +1,530 @@
+#include "uarch_probe.h"
+#include "config.h"
+#include "matrix.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define UARCH_REPEATS 5
+#define UARCH_CLOCK_ADDS (1 << 24)
+#define UARCH_FMA_ITERATIONS (1 << 22)
+
+// Pointer-chase working sets run from 4KB to a few times the reported LLC
+#define UARCH_CHASE_MIN_BYTES ((size_t)4 * 1024)
+#define UARCH_CHASE_MIN_MAX_BYTES ((size_t)32 * 1024 * 1024)
+#define UARCH_CHASE_MAX_BYTES ((size_t)256 * 1024 * 1024)
+#define UARCH_CHASE_STEPS (1 << 20)
+#define UARCH_MAX_POINTS 64
+
+// DRAM triad: four times the largest cache, within these bounds
+#define UARCH_MIN_DRAM_BYTES ((size_t)64 * 1024 * 1024)
+#define UARCH_MAX_DRAM_BYTES ((size_t)512 * 1024 * 1024)
+
+// Line size probe: two loads per block, 0 and d bytes into it
+#define UARCH_LINE_BLOCK 1024
+#define UARCH_LINE_MIN 8
+#define UARCH_LINE_MAX 512
+
+// Latency still rising this much per point means the level has not settled
+#define UARCH_LEVEL_SETTLE 1.15
+
+// Keep a value in a register without letting the compiler fold or
+// vectorize the arithmetic around it. "x" covers only xmm0-15, so with
+// AVX-512 "v" lets the barrier use all 32 registers.
+#if defined(__AVX512F__)
+#define FP_BARRIER(v) __asm__ volatile("" : "+v"(v))
+#elif defined(__x86_64__) || defined(__i386__)
+#define FP_BARRIER(v) __asm__ volatile("" : "+x"(v))
+#elif defined(__aarch64__)
+#define FP_BARRIER(v) __asm__ volatile("" : "+w"(v))
+#elif defined(__riscv)
+#define FP_BARRIER(v) __asm__ volatile("" : "+f"(v))
+#else
+#define FP_BARRIER(v) ((void)0)
+#endif
+#define INT_BARRIER(v) __asm__ volatile("" : "+r"(v))
+
+#if defined(__AVX512F__) || defined(__aarch64__) || defined(__riscv)
+#define UARCH_FP_REGISTERS 32
+#else
+#define UARCH_FP_REGISTERS 16
+#endif
+
+static volatile double uarch_sink;
+static void * volatile uarch_chase_sink;
+
+// Clock: one add per cycle through a dependent chain on every core we know.
+// The addend is a register the compiler cannot see through, since some cores
+// fold chains of add-immediate at rename.
+static double measure_clock_ghz(void) {
+    double best = 0.0;
+    Timer timer;
+
+    for (int r = 0; r < UARCH_REPEATS; r++) {
+        size_t x = 0, one = 1;
+        INT_BARRIER(one);
+        timer_start(&timer);
+        for (size_t i = 0; i < UARCH_CLOCK_ADDS; i += 8) {
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+            x += one; INT_BARRIER(x);
+        }
+        timer_stop(&timer);
+        uarch_sink = (double)x;
+
+        double ghz = UARCH_CLOCK_ADDS / (timer_elapsed_seconds(&timer) * 1e9);
+        if (ghz > best) best = ghz;
+    }
+    return best;
+}
+
+// FMA chains: N independent accumulators, each a dependent chain. The
+// accumulators are named scalars, unrolled like the RVV micro-kernels, and
+// the barrier pins each to a register; an array would live on the stack
+// and add a store and reload to every step. Two more registers hold the
+// multiplier and addend.
+#define FMA_REP1(X)  X(0)
+#define FMA_REP2(X)  FMA_REP1(X) X(1)
+#define FMA_REP3(X)  FMA_REP2(X) X(2)
+#define FMA_REP4(X)  FMA_REP3(X) X(3)
+#define FMA_REP5(X)  FMA_REP4(X) X(4)
+#define FMA_REP6(X)  FMA_REP5(X) X(5)
+#define FMA_REP8(X)  FMA_REP6(X) X(6) X(7)
+#define FMA_REP10(X) FMA_REP8(X) X(8) X(9)
+#define FMA_REP12(X) FMA_REP10(X) X(10) X(11)
+#define FMA_REP14(X) FMA_REP12(X) X(12) X(13)
+#define FMA_REP16(X) FMA_REP14(X) X(14) X(15)
+#define FMA_REP20(X) FMA_REP16(X) X(16) X(17) X(18) X(19)
+#define FMA_REP24(X) FMA_REP20(X) X(20) X(21) X(22) X(23)
+
+#define FMA_ACC_INIT(c) double acc##c = 1.0 + (c) * 1e-3;
+#define FMA_ACC_STEP(c) acc##c = fma(acc##c, m, a); FP_BARRIER(acc##c);
+#define FMA_ACC_SUM(c)  sum += acc##c;
+
+#define DEFINE_FMA_CHAINS(N)                                        \
+    static double fma_chains_##N(size_t iterations) {               \
+        double m = 0.9999999, a = 1e-7, sum = 0.0;                  \
+        FMA_REP##N(FMA_ACC_INIT)                                    \
+        FP_BARRIER(m);                                              \
+        FP_BARRIER(a);                                              \
+        for (size_t it = 0; it < iterations; it++) {                \
+            FMA_REP##N(FMA_ACC_STEP)                                \
+        }                                                           \
+        FMA_REP##N(FMA_ACC_SUM)                                     \
+        return sum;                                                 \
+    }
+
+DEFINE_FMA_CHAINS(1)
+DEFINE_FMA_CHAINS(2)
+DEFINE_FMA_CHAINS(3)
+DEFINE_FMA_CHAINS(4)
+DEFINE_FMA_CHAINS(5)
+DEFINE_FMA_CHAINS(6)
+DEFINE_FMA_CHAINS(8)
+DEFINE_FMA_CHAINS(10)
+DEFINE_FMA_CHAINS(12)
+DEFINE_FMA_CHAINS(14)
+#if UARCH_FP_REGISTERS >= 32
+DEFINE_FMA_CHAINS(16)
+DEFINE_FMA_CHAINS(20)
+DEFINE_FMA_CHAINS(24)
+#endif
+
+static const struct {
+    int chains;
+    double (*run)(size_t iterations);
+} fma_tests[] = {
+    { 1, fma_chains_1 }, { 2, fma_chains_2 }, { 3, fma_chains_3 }, { 4, fma_chains_4 },
+    { 5, fma_chains_5 }, { 6, fma_chains_6 }, { 8, fma_chains_8 }, { 10, fma_chains_10 },
+    { 12, fma_chains_12 }, { 14, fma_chains_14 },
+#if UARCH_FP_REGISTERS >= 32
+    { 16, fma_chains_16 }, { 20, fma_chains_20 }, { 24, fma_chains_24 },
+#endif
+};
+#define NUM_FMA_TESTS (sizeof(fma_tests) / sizeof(fma_tests[0]))
+
+// Latency from one chain; throughput from the best rate over all counts,
+// and the chains needed from the first count within UARCH_SATURATION of it
+static void probe_fma(UarchProfile *profile, FILE *log) {
+    double per_cycle[NUM_FMA_TESTS];
+    double best = 0.0;
+    double cycles_per_second = profile->clock_ghz * 1e9;
+    Timer timer;
+
+    if (log) {
+        fprintf(log, "\n%-8s %-12s %-12s\n", "Chains", "FMA/cycle", "ns/FMA");
+        fprintf(log, "%-8s %-12s %-12s\n", "------", "---------", "------");
+    }
+    for (size_t t = 0; t < NUM_FMA_TESTS; t++) {
+        double fmas = (double)fma_tests[t].chains * UARCH_FMA_ITERATIONS;
+        double seconds = 0.0;
+
+        for (int r = 0; r < UARCH_REPEATS; r++) {
+            timer_start(&timer);
+            uarch_sink = fma_tests[t].run(UARCH_FMA_ITERATIONS);
+            timer_stop(&timer);
+            double elapsed = timer_elapsed_seconds(&timer);
+            if (r == 0 || elapsed < seconds) seconds = elapsed;
+        }
+        per_cycle[t] = fmas / (seconds * cycles_per_second);
+        if (per_cycle[t] > best) best = per_cycle[t];
+        if (log) {
+            fprintf(log, "%-8d %-12.2f %-12.3f\n", fma_tests[t].chains, per_cycle[t],
+                    seconds * 1e9 / fmas);
+        }
+    }
+
+    profile->fma_latency = 1.0 / per_cycle[0];
+    profile->fma_per_cycle = best;
+    profile->fma_chains = fma_tests[NUM_FMA_TESTS - 1].chains;
+    for (size_t t = 0; t < NUM_FMA_TESTS; t++) {
+        if (per_cycle[t] >= UARCH_SATURATION * best) {
+            profile->fma_chains = fma_tests[t].chains;
+            break;
+        }
+    }
+}
+
+// xorshift64; only needs to defeat the prefetchers
+static uint64_t chase_next(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void shuffle(size_t *order, size_t count) {
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = (size_t)(chase_next(&state) % (i + 1));
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+}
+
+// Follow the pointer ring from start: one untimed lap of warm-up nodes,
+// then the best of two timed runs. Returns ns per load.
+static double chase_ns(void *start, size_t nodes) {
+    size_t steps = UARCH_CHASE_STEPS;
+    void *p = start;
+    double best = 0.0;
+    Timer timer;
+
+    for (size_t s = 0; s < nodes; s++) {
+        p = *(void **)p;
+    }
+    for (int r = 0; r < 2; r++) {
+        timer_start(&timer);
+        for (size_t s = 0; s < steps; s += 8) {
+            p = *(void **)p; p = *(void **)p; p = *(void **)p; p = *(void **)p;
+            p = *(void **)p; p = *(void **)p; p = *(void **)p; p = *(void **)p;
+        }
+        timer_stop(&timer);
+        double ns = timer_elapsed_seconds(&timer) * 1e9 / (double)steps;
+        if (r == 0 || ns < best) best = ns;
+    }
+    uarch_chase_sink = p;
+    return best;
+}
+
+// Random ring over bytes / stride nodes, one per stride
+static double chase_working_set(char *buffer, size_t bytes, size_t stride, size_t *order) {
+    size_t nodes = bytes / stride;
+
+    shuffle(order, nodes);
+    for (size_t i = 0; i < nodes; i++) {
+        *(void **)(buffer + order[i] * stride) = buffer + order[(i + 1) % nodes] * stride;
+    }
+    return chase_ns(buffer + order[0] * stride, nodes);
+}
+
+// A level ends at the last working set before latency rises UARCH_LEVEL_JUMP
+// over its plateau; the next plateau starts once the curve stops climbing
+static void find_cache_levels(UarchProfile *profile, const size_t *bytes,
+                              const double *ns, size_t count) {
+    double plateau = ns[0];
+    size_t i = 1;
+
+    profile->cache_levels = 0;
+    while (i < count && profile->cache_levels < UARCH_MAX_LEVELS) {
+        if (ns[i] < plateau * UARCH_LEVEL_JUMP) {
+            i++;
+            continue;
+        }
+        profile->cache_bytes[profile->cache_levels] = bytes[i - 1];
+        profile->cache_latency_ns[profile->cache_levels] = plateau;
+        profile->cache_levels++;
+        while (i + 1 < count && ns[i + 1] > ns[i] * UARCH_LEVEL_SETTLE) {
+            i++;
+        }
+        plateau = ns[i];
+        i++;
+    }
+}
+
+static void probe_caches(UarchProfile *profile, char *buffer, size_t max_bytes,
+                         size_t *order, FILE *log) {
+    size_t bytes[UARCH_MAX_POINTS];
+    double ns[UARCH_MAX_POINTS];
+    size_t count = 0;
+
+    if (log) {
+        fprintf(log, "\n%-12s %-10s %-10s\n", "Set (KB)", "ns/load", "cycles");
+        fprintf(log, "%-12s %-10s %-10s\n", "--------", "-------", "------");
+    }
+    // Points at 2^k and 1.5 * 2^k
+    for (size_t ws = UARCH_CHASE_MIN_BYTES; ws <= max_bytes && count + 1 < UARCH_MAX_POINTS; ws *= 2) {
+        for (int half = 0; half < 2; half++) {
+            size_t size = half ? ws + ws / 2 : ws;
+            if (size > max_bytes) break;
+            bytes[count] = size;
+            ns[count] = chase_working_set(buffer, size, CACHE_LINE_SIZE, order);
+            if (log) {
+                fprintf(log, "%-12zu %-10.2f %-10.1f\n", size / 1024, ns[count],
+                        ns[count] * profile->clock_ghz);
+            }
+            count++;
+        }
+    }
+    find_cache_levels(profile, bytes, ns, count);
+}
+
+// Within a working set that misses L1 but fits L2, the second load of each
+// block is an L1 hit only while both offsets share a line
+static void probe_line_size(UarchProfile *profile, char *buffer, size_t *order, FILE *log) {
+    size_t l1 = profile->cache_levels >= 1 ? profile->cache_bytes[0] : get_cache_size(1);
+    size_t bytes = 4 * l1;
+    double ns[16], base, top;
+    size_t count = 0;
+
+    if (profile->cache_levels >= 2 && bytes > profile->cache_bytes[1] / 2) {
+        bytes = profile->cache_bytes[1] / 2;
+    }
+    size_t blocks = bytes / UARCH_LINE_BLOCK;
+    if (blocks < 16) blocks = 16;
+
+    if (log) {
+        fprintf(log, "\n%-12s %-10s\n", "Offset", "ns/load");
+        fprintf(log, "%-12s %-10s\n", "------", "-------");
+    }
+    shuffle(order, blocks);
+    for (size_t d = UARCH_LINE_MIN; d <= UARCH_LINE_MAX; d *= 2) {
+        for (size_t k = 0; k < blocks; k++) {
+            char *first = buffer + order[k] * UARCH_LINE_BLOCK;
+            *(void **)first = first + d;
+            *(void **)(first + d) = buffer + order[(k + 1) % blocks] * UARCH_LINE_BLOCK;
+        }
+        ns[count] = chase_ns(buffer + order[0] * UARCH_LINE_BLOCK, 2 * blocks);
+        if (log) fprintf(log, "%-12zu %-10.2f\n", d, ns[count]);
+        count++;
+    }
+
+    // No contrast between the smallest and largest offsets: no answer
+    base = ns[0];
+    top = ns[count - 1];
+    profile->line_size = 0;
+    if (top < base * 1.2) return;
+    for (size_t i = 0, d = UARCH_LINE_MIN; i < count; i++, d *= 2) {
+        if (ns[i] > 0.5 * (base + top)) {
+            profile->line_size = d;
+            break;
+        }
+    }
+}
+
+// Roofline ceilings with each cache level streamed at half its measured
+// size, falling back to sysfs for levels the chase did not find
+static void probe_ceilings(UarchProfile *profile) {
+    size_t largest = 0;
+
+    profile->peak_gflops = roofline_measure_peak(ROOFLINE_TEST_SECONDS);
+    for (int level = 0; level < UARCH_MAX_LEVELS; level++) {
+        size_t bytes = level < profile->cache_levels ? profile->cache_bytes[level]
+                                                     : get_cache_size(level + 1);
+        if (bytes > largest) largest = bytes;
+        profile->bandwidth_gbs[ROOF_L1 + level] =
+            roofline_measure_bandwidth(bytes / 2, ROOFLINE_TEST_SECONDS);
+    }
+
+    size_t dram = 4 * largest;
+    if (dram < UARCH_MIN_DRAM_BYTES) dram = UARCH_MIN_DRAM_BYTES;
+    if (dram > UARCH_MAX_DRAM_BYTES) dram = UARCH_MAX_DRAM_BYTES;
+    profile->bandwidth_gbs[ROOF_DRAM] = roofline_measure_bandwidth(dram, ROOFLINE_TEST_SECONDS);
+}
+
+int uarch_probe(UarchProfile *profile, FILE *log) {
+    size_t max_bytes = 4 * get_cache_size(3);
+    char *buffer;
+    size_t *order;
+
+    memset(profile, 0, sizeof(*profile));
+    get_cpu_model(profile->cpu_model, sizeof(profile->cpu_model));
+    profile->fp_registers = UARCH_FP_REGISTERS;
+
+    profile->clock_ghz = measure_clock_ghz();
+    if (profile->clock_ghz <= 0.0) return -1;
+    probe_fma(profile, log);
+
+    if (max_bytes < UARCH_CHASE_MIN_MAX_BYTES) max_bytes = UARCH_CHASE_MIN_MAX_BYTES;
+    if (max_bytes > UARCH_CHASE_MAX_BYTES) max_bytes = UARCH_CHASE_MAX_BYTES;
+    buffer = aligned_malloc(max_bytes, 2 * 1024 * 1024);
+    order = malloc(max_bytes / CACHE_LINE_SIZE * sizeof(size_t));
+    if (!buffer || !order) {
+        aligned_free(buffer);
+        free(order);
+        return -1;
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Huge pages keep TLB misses from posing as another cache level
+    madvise(buffer, max_bytes, MADV_HUGEPAGE);
+#endif
+    probe_caches(profile, buffer, max_bytes, order, log);
+    probe_line_size(profile, buffer, order, log);
+
+    aligned_free(buffer);
+    free(order);
+    probe_ceilings(profile);
+    uarch_select_blocking(profile);
+    return 0;
+}
+
+// The tile comes from the cache sizes here; the chain count reaches the
+// kernels through matrix_fma_chains, which sets the floor on accumulators
+// per register block when the RVV kernels choose their LMUL and rows
+void uarch_select_blocking(UarchProfile *profile) {
+    // Three tiles share the measured L2, else L1, else the sysfs L2
+    size_t cache = profile->cache_levels >= 2 ? profile->cache_bytes[1]
+                 : profile->cache_levels == 1 ? profile->cache_bytes[0] : get_cache_size(2);
+    profile->tile_size = calculate_optimal_tile_size(cache, sizeof(double));
+}
+
+int uarch_profile_save(const UarchProfile *p, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    fprintf(f, "# Machine profile written by matrix_mult --probe\n");
+    fprintf(f, "cpu_model = %s\n", p->cpu_model);
+    fprintf(f, "clock_ghz = %.3f\n", p->clock_ghz);
+    fprintf(f, "fma_latency = %.2f\n", p->fma_latency);
+    fprintf(f, "fma_per_cycle = %.2f\n", p->fma_per_cycle);
+    fprintf(f, "fma_chains = %d\n", p->fma_chains);
+    fprintf(f, "line_size = %zu\n", p->line_size);
+    fprintf(f, "cache_levels = %d\n", p->cache_levels);
+    for (int i = 0; i < p->cache_levels; i++) {
+        fprintf(f, "l%d_bytes = %zu\n", i + 1, p->cache_bytes[i]);
+        fprintf(f, "l%d_latency_ns = %.2f\n", i + 1, p->cache_latency_ns[i]);
+    }
+    fprintf(f, "fp_registers = %d\n", p->fp_registers);
+    fprintf(f, "tile_size = %zu\n", p->tile_size);
+    fprintf(f, "peak_gflops = %.3f\n", p->peak_gflops);
+    for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+        fprintf(f, "bandwidth_%s_gbs = %.3f\n", roofline_level_name((RoofLevel)level),
+                p->bandwidth_gbs[level]);
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int uarch_profile_load(UarchProfile *p, const char *path) {
+    char line[256], model[128];
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    memset(p, 0, sizeof(*p));
+    while (fgets(line, sizeof(line), f)) {
+        char *eq = strchr(line, '=');
+        char *key = line, *value, *end;
+        int level;
+
+        if (line[0] == '#' || !eq) continue;
+        for (end = eq; end > key && (end[-1] == ' ' || end[-1] == '\t'); end--) {}
+        *end = '\0';
+        for (value = eq + 1; *value == ' ' || *value == '\t'; value++) {}
+        value[strcspn(value, "\r\n")] = '\0';
+
+        if (strcmp(key, "cpu_model") == 0) {
+            snprintf(p->cpu_model, sizeof(p->cpu_model), "%s", value);
+        } else if (strcmp(key, "clock_ghz") == 0) {
+            p->clock_ghz = atof(value);
+        } else if (strcmp(key, "fma_latency") == 0) {
+            p->fma_latency = atof(value);
+        } else if (strcmp(key, "fma_per_cycle") == 0) {
+            p->fma_per_cycle = atof(value);
+        } else if (strcmp(key, "fma_chains") == 0) {
+            p->fma_chains = atoi(value);
+        } else if (strcmp(key, "line_size") == 0) {
+            p->line_size = (size_t)strtoull(value, NULL, 10);
+        } else if (strcmp(key, "cache_levels") == 0) {
+            p->cache_levels = atoi(value);
+        } else if (sscanf(key, "l%d_", &level) == 1 && level >= 1 && level <= UARCH_MAX_LEVELS) {
+            if (strstr(key, "_bytes")) p->cache_bytes[level - 1] = (size_t)strtoull(value, NULL, 10);
+            else if (strstr(key, "_latency_ns")) p->cache_latency_ns[level - 1] = atof(value);
+        } else if (strcmp(key, "fp_registers") == 0) {
+            p->fp_registers = atoi(value);
+        } else if (strcmp(key, "tile_size") == 0) {
+            p->tile_size = (size_t)strtoull(value, NULL, 10);
+        } else if (strcmp(key, "peak_gflops") == 0) {
+            p->peak_gflops = atof(value);
+        } else if (strncmp(key, "bandwidth_", 10) == 0) {
+            for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+                const char *name = roofline_level_name((RoofLevel)level);
+                size_t len = strlen(name);
+                if (strncmp(key + 10, name, len) == 0 && strcmp(key + 10 + len, "_gbs") == 0) {
+                    p->bandwidth_gbs[level] = atof(value);
+                }
+            }
+        }
+    }
+    fclose(f);
+
+    if (p->tile_size == 0 || p->cache_levels < 0 || p->cache_levels > UARCH_MAX_LEVELS) {
+        return -1;
+    }
+    get_cpu_model(model, sizeof(model));
+    return strcmp(model, p->cpu_model) == 0 ? 0 : 1;
+}
+
+void print_uarch_profile(FILE *out, const UarchProfile *p) {
+    fprintf(out, "\nMachine profile (%s):\n", p->cpu_model);
+    fprintf(out, "  Clock:           %.2f GHz (dependent add chain)\n", p->clock_ghz);
+    fprintf(out, "  FMA latency:     %.1f cycles\n", p->fma_latency);
+    fprintf(out, "  FMA throughput:  %.2f per cycle, reached with %d chains\n",
+            p->fma_per_cycle, p->fma_chains);
+    if (p->line_size) {
+        fprintf(out, "  Cache line:      %zu bytes\n", p->line_size);
+    } else {
+        fprintf(out, "  Cache line:      not detected\n");
+    }
+    for (int i = 0; i < p->cache_levels; i++) {
+        fprintf(out, "  L%d cache:        %zu KB, %.1f ns load-to-use\n", i + 1,
+                p->cache_bytes[i] / 1024, p->cache_latency_ns[i]);
+    }
+    if (p->cache_levels == 0) {
+        fprintf(out, "  Caches:          no latency steps detected\n");
+    }
+    fprintf(out, "  FP registers:    %d\n", p->fp_registers);
+    fprintf(out, "  Tile size:       %zu\n", p->tile_size);
+    if (p->peak_gflops > 0.0) {
+        fprintf(out, "  Peak FMA rate:   %.2f GFLOPS\n", p->peak_gflops);
+        fprintf(out, "  Bandwidth:      ");
+        for (int level = 0; level < ROOF_NUM_LEVELS; level++) {
+            fprintf(out, " %s %.1f GB/s%s", roofline_level_name((RoofLevel)level),
+                    p->bandwidth_gbs[level], level + 1 < ROOF_NUM_LEVELS ? "," : "\n");
+        }
+    }
+}
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include <time.h>
 
 #ifdef _WIN32
@@ -11,10 +12,98 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <sys/sysinfo.h>
+#include <sys/mman.h>
 #endif
 
+// Cycle counter access
+//
+// RISC-V Linux may disable user access to the cycle CSR (it traps with
+// SIGILL), so availability is probed once under a signal handler.
+#if defined(__riscv) && !defined(_WIN32)
+#include <signal.h>
+#include <setjmp.h>
+
+static sigjmp_buf csr_probe_env;
+
+static void csr_probe_handler(int sig) {
+    (void)sig;
+    siglongjmp(csr_probe_env, 1);
+}
+
+static inline uint64_t read_rdcycle(void) {
+    uint64_t value;
+    __asm__ volatile("rdcycle %0" : "=r"(value));
+    return value;
+}
+
+static inline uint64_t read_rdtime(void) {
+    uint64_t value;
+    __asm__ volatile("rdtime %0" : "=r"(value));
+    return value;
+}
+
+static int csr_readable(uint64_t (*reader)(void)) {
+    struct sigaction sa, old;
+    volatile int ok = 0;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = csr_probe_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGILL, &sa, &old);
+    if (sigsetjmp(csr_probe_env, 1) == 0) {
+        uint64_t a = reader();
+        uint64_t b = reader();
+        ok = b >= a;
+    }
+    sigaction(SIGILL, &old, NULL);
+    return ok;
+}
+
+static uint64_t (*csr_reader)(void) = read_rdcycle;
+#define CYCLE_COUNTER_SUPPORTED 1
+
+#elif (defined(__x86_64__) || defined(__i386__)) && !defined(_WIN32)
+#include <x86intrin.h>
+#define CYCLE_COUNTER_SUPPORTED 1
+#endif
+
+static TimerBackend active_backend = TIMER_CLOCK;
+static int backend_counts_cycles = 0;
+static double tick_frequency = 0.0;     // Ticks per second of the cycle backend
+static double overhead_seconds = 0.0;   // Cost of an empty start/stop pair
+
+static inline uint64_t cycle_counter_start(void) {
+#if defined(__riscv) && defined(CYCLE_COUNTER_SUPPORTED)
+    return csr_reader();
+#elif defined(CYCLE_COUNTER_SUPPORTED)
+    // Keep earlier instructions from drifting into the timed region
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static inline uint64_t cycle_counter_stop(void) {
+#if defined(__riscv) && defined(CYCLE_COUNTER_SUPPORTED)
+    return csr_reader();
+#elif defined(CYCLE_COUNTER_SUPPORTED)
+    // rdtscp waits for the timed code to retire
+    unsigned int aux;
+    uint64_t value = __rdtscp(&aux);
+    _mm_lfence();
+    return value;
+#else
+    return 0;
+#endif
+}
+
 // Timer functions
 void timer_start(Timer *timer) {
+    if (active_backend == TIMER_CYCLES) {
+        timer->start_ticks = cycle_counter_start();
+        return;
+    }
 #ifdef _WIN32
     QueryPerformanceCounter((LARGE_INTEGER*)&timer->start);
 #else
@@ -23,6 +112,10 @@ void timer_start(Timer *timer) {
 }
 
 void timer_stop(Timer *timer) {
+    if (active_backend == TIMER_CYCLES) {
+        timer->end_ticks = cycle_counter_stop();
+        return;
+    }
 #ifdef _WIN32
     QueryPerformanceCounter((LARGE_INTEGER*)&timer->end);
 #else
@@ -30,18 +123,137 @@ void timer_stop(Timer *timer) {
 #endif
 }
 
-double timer_elapsed_seconds(const Timer *timer) {
+static double timer_raw_seconds(const Timer *timer) {
+    if (active_backend == TIMER_CYCLES) {
+        return (double)(timer->end_ticks - timer->start_ticks) / tick_frequency;
+    }
 #ifdef _WIN32
     LARGE_INTEGER frequency;
     QueryPerformanceFrequency(&frequency);
     return (double)(timer->end - timer->start) / frequency.QuadPart;
 #else
-    double start_sec = timer->start.tv_sec + timer->start.tv_nsec / 1e9;
-    double end_sec = timer->end.tv_sec + timer->end.tv_nsec / 1e9;
-    return end_sec - start_sec;
+    // Subtract in integers so short intervals keep nanosecond precision
+    long long ns = (long long)(timer->end.tv_sec - timer->start.tv_sec) * 1000000000LL +
+                   (long long)(timer->end.tv_nsec - timer->start.tv_nsec);
+    return (double)ns / 1e9;
 #endif
 }
 
+double timer_elapsed_seconds(const Timer *timer) {
+    double seconds = timer_raw_seconds(timer) - overhead_seconds;
+    return seconds > 0.0 ? seconds : 0.0;
+}
+
+static double clock_now_seconds(void) {
+    Timer t;
+    TimerBackend saved = active_backend;
+    active_backend = TIMER_CLOCK;
+    timer_start(&t);
+    active_backend = saved;
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (double)t.start / frequency.QuadPart;
+#else
+    return (double)t.start.tv_sec + (double)t.start.tv_nsec / 1e9;
+#endif
+}
+
+// Ticks per second of the cycle counter, measured against the OS clock
+static double calibrate_tick_frequency(void) {
+    const double interval = 0.02;
+    double best = 0.0;
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        double t0 = clock_now_seconds();
+        uint64_t c0 = cycle_counter_start();
+        double t1;
+        do {
+            t1 = clock_now_seconds();
+        } while (t1 - t0 < interval);
+        uint64_t c1 = cycle_counter_stop();
+        double hz = (double)(c1 - c0) / (t1 - t0);
+        if (hz > best) best = hz;
+    }
+    return best;
+}
+
+// Minimum cost of an empty start/stop pair in the active backend
+static double calibrate_overhead(void) {
+    double best = 1.0;
+    Timer t;
+
+    overhead_seconds = 0.0;
+    for (int i = 0; i < 1000; i++) {
+        timer_start(&t);
+        timer_stop(&t);
+        double seconds = timer_raw_seconds(&t);
+        if (seconds < best) best = seconds;
+    }
+    return best;
+}
+
+TimerBackend timer_init(TimerBackend requested) {
+    active_backend = TIMER_CLOCK;
+    backend_counts_cycles = 0;
+    tick_frequency = 0.0;
+
+#ifdef CYCLE_COUNTER_SUPPORTED
+    if (requested == TIMER_CYCLES) {
+        int usable = 1;
+#if defined(__riscv)
+        if (csr_readable(read_rdcycle)) {
+            csr_reader = read_rdcycle;
+            backend_counts_cycles = 1;
+        } else if (csr_readable(read_rdtime)) {
+            csr_reader = read_rdtime;
+        } else {
+            usable = 0;
+        }
+#endif
+        if (usable) {
+            tick_frequency = calibrate_tick_frequency();
+            if (tick_frequency > 0.0) {
+                active_backend = TIMER_CYCLES;
+            } else {
+                backend_counts_cycles = 0;
+            }
+        }
+    }
+#else
+    (void)requested;
+#endif
+
+    overhead_seconds = calibrate_overhead();
+    return active_backend;
+}
+
+TimerBackend timer_backend(void) {
+    return active_backend;
+}
+
+const char* timer_backend_name(void) {
+    if (active_backend == TIMER_CLOCK) return "clock";
+#if defined(__riscv)
+    return backend_counts_cycles ? "rdcycle" : "rdtime";
+#else
+    return "rdtsc";
+#endif
+}
+
+// Only rdcycle follows the core clock; the TSC and rdtime tick at a fixed rate
+int timer_counts_core_cycles(void) {
+    return active_backend == TIMER_CYCLES && backend_counts_cycles;
+}
+
+double timer_tick_frequency(void) {
+    return tick_frequency;
+}
+
+double timer_overhead_seconds(void) {
+    return overhead_seconds;
+}
+
 double timer_elapsed_ms(const Timer *timer) {
     return timer_elapsed_seconds(timer) * 1000.0;
 }
@@ -85,6 +297,30 @@ void aligned_free(void *ptr) {
 #endif
 }
 
+// Page-aligned memory whose pages are faulted in up front (MAP_POPULATE),
+// so the first write does not pay for page faults
+void* prefaulted_malloc(size_t size) {
+#if defined(__linux__)
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+#else
+    void *ptr = aligned_malloc(size, 4096);
+    if (ptr) memset(ptr, 0, size);
+    return ptr;
+#endif
+}
+
+void prefaulted_free(void *ptr, size_t size) {
+    if (!ptr) return;
+#if defined(__linux__)
+    munmap(ptr, size);
+#else
+    (void)size;
+    aligned_free(ptr);
+#endif
+}
+
 // System information
 void print_system_info(void) {
     printf("System Information:\n");
@@ -119,7 +355,12 @@ void print_system_info(void) {
     }
 #endif
 
-    printf("  Architecture: RISC-V (emulated/cross-compiled)\n");
+    char cpu_model[128];
+    get_cpu_model(cpu_model, sizeof(cpu_model));
+    printf("  CPU: %s\n", cpu_model);
+    printf("  Architecture: %s\n", get_isa_string());
+    printf("  Cache sizes: L1d %zu KB, L2 %zu KB, L3 %zu KB\n",
+           get_cache_size(1) / 1024, get_cache_size(2) / 1024, get_cache_size(3) / 1024);
     
 #ifdef USE_VECTOR
     printf("  Vector extensions: enabled\n");
@@ -130,10 +371,56 @@ void print_system_info(void) {
     printf("\n");
 }
 
+#ifdef __linux__
+// Parse sysfs cache sizes such as "32K" or "2048K"
+static size_t parse_cache_size(const char *text) {
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (*end == 'K') value *= 1024ULL;
+    else if (*end == 'M') value *= 1024ULL * 1024ULL;
+    return (size_t)value;
+}
+
+// Read the data/unified cache size for a level from cpu0's sysfs entries
+static size_t read_sysfs_cache_size(int level) {
+    char path[128];
+    char buf[64];
+
+    for (int index = 0; index < 16; index++) {
+        FILE *f;
+        int file_level = 0;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        f = fopen(path, "r");
+        if (!f) break;
+        if (fscanf(f, "%d", &file_level) != 1) file_level = 0;
+        fclose(f);
+        if (file_level != level) continue;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        f = fopen(path, "r");
+        if (!f) continue;
+        if (!fgets(buf, sizeof(buf), f)) buf[0] = '\0';
+        fclose(f);
+        if (strncmp(buf, "Instruction", 11) == 0) continue;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        f = fopen(path, "r");
+        if (!f) continue;
+        size_t size = fgets(buf, sizeof(buf), f) ? parse_cache_size(buf) : 0;
+        fclose(f);
+        if (size > 0) return size;
+    }
+    return 0;
+}
+#endif
+
 size_t get_cache_size(int level) {
-    // This is a simplified implementation
-    // In a real RISC-V system, you would read from hardware registers
-    // or system files to get actual cache sizes
+#ifdef __linux__
+    size_t size = read_sysfs_cache_size(level);
+    if (size > 0) return size;
+#endif
+    // Fall back to typical values when the platform does not report sizes
     switch (level) {
         case 1: return 32 * 1024;     // 32KB L1 cache
         case 2: return 256 * 1024;    // 256KB L2 cache
@@ -142,6 +429,63 @@ size_t get_cache_size(int level) {
     }
 }
 
+int get_num_processors(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+    return nprocs > 0 ? (int)nprocs : 1;
+#endif
+}
+
+void get_cpu_model(char *buf, size_t len) {
+    snprintf(buf, len, "unknown");
+#ifdef __linux__
+    // x86 reports "model name"; RISC-V kernels report "uarch" and "isa"
+    static const char *keys[] = { "model name", "uarch", "isa", "Processor" };
+    char line[256];
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+        rewind(f);
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, keys[k], strlen(keys[k])) != 0) continue;
+            char *colon = strchr(line, ':');
+            if (!colon) continue;
+            colon++;
+            while (*colon == ' ' || *colon == '\t') colon++;
+            colon[strcspn(colon, "\n")] = '\0';
+            snprintf(buf, len, "%s", colon);
+            fclose(f);
+            return;
+        }
+    }
+    fclose(f);
+#endif
+}
+
+// Instruction set the binary was compiled for
+const char* get_isa_string(void) {
+#if defined(__riscv) && defined(__riscv_vector)
+    return "riscv64-v";
+#elif defined(__riscv)
+    return "riscv64";
+#elif defined(__x86_64__) && defined(__AVX512F__)
+    return "x86_64-avx512";
+#elif defined(__x86_64__) && defined(__AVX2__)
+    return "x86_64-avx2";
+#elif defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#elif defined(__aarch64__)
+    return "aarch64";
+#else
+    return "unknown";
+#endif
+}
+
 // Random number generation
 static unsigned int random_seed = 1;
 
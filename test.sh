@@ -40,7 +40,8 @@ init_reports() {
     echo "======================================================" >> $REPORT_FILE
     echo "" >> $REPORT_FILE
     
-    echo "Matrix Size,Method,Time (ms),GFLOPS" > $CSV_FILE
+    # The header is taken from the first result file written by the benchmark
+    : > $CSV_FILE
 }
 
 # Function to run a single test and capture output
@@ -61,7 +62,53 @@ run_test() {
     echo "Arguments: $args" >> $REPORT_FILE
     echo "Output:" >> $REPORT_FILE
     
-    ./$PROJECT_NAME $args $size 2>&1 | tee -a $REPORT_FILE
+    local results_tmp
+    results_tmp=$(mktemp)
+    
+    ./$PROJECT_NAME $args --format=csv --output="$results_tmp" $size 2>&1 | tee -a $REPORT_FILE
+    
+    # Append the machine-readable per-iteration records
+    if [ -s "$CSV_FILE" ]; then
+        tail -n +2 "$results_tmp" >> $CSV_FILE
+    else
+        cat "$results_tmp" > $CSV_FILE
+    fi
+    rm -f "$results_tmp"
+    
+    echo "" >> $REPORT_FILE
+    echo "------------------------------------------------------" >> $REPORT_FILE
+    echo "" >> $REPORT_FILE
+}
+
+# Function to run an in-process parameter sweep and capture output
+run_sweep() {
+    local items=$1
+    local args=$2
+    local description=$3
+    
+    print_status "Running sweep: $description"
+    
+    if [ ! -f "./$PROJECT_NAME" ]; then
+        print_error "Executable not found. Please build the project first."
+        return 1
+    fi
+    
+    echo "Test: $description" >> $REPORT_FILE
+    echo "Sweep: $items" >> $REPORT_FILE
+    echo "Arguments: $args" >> $REPORT_FILE
+    echo "Output:" >> $REPORT_FILE
+    
+    local results_tmp
+    results_tmp=$(mktemp)
+    
+    ./$PROJECT_NAME $args --format=csv --output="$results_tmp" --sweep $items 2>&1 | tee -a $REPORT_FILE
+    
+    if [ -s "$CSV_FILE" ]; then
+        tail -n +2 "$results_tmp" >> $CSV_FILE
+    else
+        cat "$results_tmp" > $CSV_FILE
+    fi
+    rm -f "$results_tmp"
     
     echo "" >> $REPORT_FILE
     echo "------------------------------------------------------" >> $REPORT_FILE
@@ -72,45 +119,28 @@ run_test() {
 run_correctness_tests() {
     print_header "Running Correctness Tests"
     
-    local test_sizes=(64 128 256)
-    
-    for size in "${test_sizes[@]}"; do
-        run_test $size "-v" "Correctness verification (size: $size)"
-    done
+    run_sweep "sizes=64,128,256" "-v" "Correctness verification (sizes: 64-256)"
 }
 
 # Function to run performance tests
 run_performance_tests() {
     print_header "Running Performance Tests"
     
-    local test_sizes=(64 128 256 512 1024)
-    
-    for size in "${test_sizes[@]}"; do
-        run_test $size "" "Performance test (size: $size)"
-    done
+    run_sweep "sizes=64,128,256,512,1024" "" "Performance test (sizes: 64-1024)"
 }
 
 # Function to run scaling tests
 run_scaling_tests() {
     print_header "Running Scaling Tests"
     
-    local test_sizes=(32 64 96 128 160 192 224 256 320 384 448 512)
-    
-    for size in "${test_sizes[@]}"; do
-        run_test $size "" "Scaling test (size: $size)"
-    done
+    run_sweep "sizes=32:256:32,320:512:64" "" "Scaling test (sizes: 32-512)"
 }
 
 # Function to test different tile sizes
 run_tile_size_tests() {
     print_header "Running Tile Size Optimization Tests"
     
-    local tile_sizes=(16 32 48 64 96 128)
-    local matrix_size=512
-    
-    for tile in "${tile_sizes[@]}"; do
-        run_test $matrix_size "-t $tile" "Tile size test (tile: $tile, matrix: $matrix_size)"
-    done
+    run_sweep "sizes=512 tiles=16,32,48,64,96,128" "" "Tile size test (tiles: 16-128, matrix: 512)"
 }
 
 # Function to run memory stress tests
@@ -142,11 +172,7 @@ run_vector_tests() {
     make clean && make vector
     
     if [ $? -eq 0 ]; then
-        local test_sizes=(128 256 512)
-        
-        for size in "${test_sizes[@]}"; do
-            run_test $size "" "Vector instruction test (size: $size)"
-        done
+        run_sweep "sizes=128,256,512" "" "Vector instruction test (sizes: 128-512)"
     else
         print_warning "Failed to build with vector instructions"
     fi
@@ -165,8 +191,12 @@ generate_summary() {
     echo "===================" >> $REPORT_FILE
     echo "" >> $REPORT_FILE
     
-    # Extract performance data from report
-    grep -E "(Naive|Tiled|Vector)" $REPORT_FILE | grep -E "[0-9]+\.[0-9]+ GFLOPS" >> $REPORT_FILE || true
+    # Mean GFLOPS per kernel and configuration from the CSV records
+    if [ -s "$CSV_FILE" ]; then
+        awk -F',' 'NR > 1 { key = $1 "," $2 "," $3; sum[key] += $8; n[key]++ }
+            END { for (k in sum) { split(k, f, ","); printf "%-10s size %-6s tile %-5s %8.2f GFLOPS\n", f[1], f[2], f[3], sum[k] / n[k] } }' \
+            $CSV_FILE | sort -k3,3n -k1,1 >> $REPORT_FILE
+    fi
     
     print_status "Performance report saved to: $REPORT_FILE"
     print_status "CSV data saved to: $CSV_FILE"